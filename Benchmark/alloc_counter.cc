@@ -0,0 +1,37 @@
+/**
+ * @file alloc_counter.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 替换全局operator new/delete，按线程计数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// 线程私有计数，避免计数本身在多线程下成为竞争点
+thread_local std::uint64_t allocations = 0;
+}  // namespace
+
+std::uint64_t thread_allocations() {
+  return allocations;
+}
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  void *p = std::malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
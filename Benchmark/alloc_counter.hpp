@@ -0,0 +1,21 @@
+/**
+ * @file alloc_counter.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 统计当前线程的堆分配次数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * alloc_counter.cc替换了全局operator new，链接它的可执行文件
+ * 可以在工作线程中读取本线程累计的分配次数。
+ */
+
+#ifndef _ALLOC_COUNTER_H_
+#define _ALLOC_COUNTER_H_
+
+#include <cstdint>
+
+std::uint64_t thread_allocations();
+
+#endif  // !_ALLOC_COUNTER_H_
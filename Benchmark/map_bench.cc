@@ -0,0 +1,166 @@
+/**
+ * @file map_bench.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 并发哈希表基准：加锁的std::unordered_map与design下的各查找表
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include "design/filtered_lookup_table.hpp"
+#include "design/flat_lookup_table.hpp"
+#include "design/split_ordered_table.hpp"
+#include "design/threadsafe_lookup_table.hpp"
+#include "map_bench.hpp"
+
+// 一把互斥锁保护整张表
+struct mutex_adapter {
+  std::mutex                                      mutex;
+  std::unordered_map<std::uint64_t, std::string> map;
+
+  bool read(std::uint64_t key, std::string &value) {
+    std::lock_guard<std::mutex> lk{mutex};
+    auto const                  found = map.find(key);
+    if (found == map.end()) {
+      return false;
+    }
+    value = found->second;
+    return true;
+  }
+
+  void put(std::uint64_t key, std::string const &value) {
+    std::lock_guard<std::mutex> lk{mutex};
+    map[key] = value;
+  }
+
+  void remove(std::uint64_t key) {
+    std::lock_guard<std::mutex> lk{mutex};
+    map.erase(key);
+  }
+};
+
+// 一把读写锁保护整张表
+struct shared_mutex_adapter {
+  boost::shared_mutex                            mutex;
+  std::unordered_map<std::uint64_t, std::string> map;
+
+  bool read(std::uint64_t key, std::string &value) {
+    boost::shared_lock<boost::shared_mutex> lk{mutex};
+    auto const                              found = map.find(key);
+    if (found == map.end()) {
+      return false;
+    }
+    value = found->second;
+    return true;
+  }
+
+  void put(std::uint64_t key, std::string const &value) {
+    std::lock_guard<boost::shared_mutex> lk{mutex};
+    map[key] = value;
+  }
+
+  void remove(std::uint64_t key) {
+    std::lock_guard<boost::shared_mutex> lk{mutex};
+    map.erase(key);
+  }
+};
+
+struct striped_adapter {
+  threadsafe_lookup_table<std::uint64_t, std::string> map;
+
+  bool read(std::uint64_t key, std::string &value) {
+    return map.visit(key, [&value](std::string const &found) {
+      value = found;
+    });
+  }
+
+  void put(std::uint64_t key, std::string const &value) {
+    map.add_or_update_mapping(key, value);
+  }
+
+  void remove(std::uint64_t key) {
+    map.remove_mapping(key);
+  }
+};
+
+// value_for不报告是否找到：以一个基准不会写入的值作默认值，
+// 返回它即表示不存在，value_size为0时空值也能正确计为命中
+inline std::string const &missing_value() {
+  static std::string const missing(1, '\0');
+  return missing;
+}
+
+struct flat_adapter {
+  flat_lookup_table<std::uint64_t, std::string> map;
+
+  bool read(std::uint64_t key, std::string &value) {
+    value = map.value_for(key, missing_value());
+    return value != missing_value();
+  }
+
+  void put(std::uint64_t key, std::string const &value) {
+    map.add_or_update_mapping(key, value);
+  }
+
+  void remove(std::uint64_t key) {
+    map.remove_mapping(key);
+  }
+};
+
+// 无锁的split-ordered list
+struct split_ordered_adapter {
+  split_ordered_table<std::uint64_t, std::string> map;
+
+  bool read(std::uint64_t key, std::string &value) {
+    value = map.value_for(key, missing_value());
+    return value != missing_value();
+  }
+
+  void put(std::uint64_t key, std::string const &value) {
+    map.add_or_update_mapping(key, value);
+  }
+
+  void remove(std::uint64_t key) {
+    map.remove_mapping(key);
+  }
+};
+
+// 查找表前置布隆过滤器
+struct filtered_adapter {
+  filtered_lookup_table<std::uint64_t, std::string> map;
+
+  bool read(std::uint64_t key, std::string &value) {
+    return map.visit(key, [&value](std::string const &found) {
+      value = found;
+    });
+  }
+
+  void put(std::uint64_t key, std::string const &value) {
+    map.add_or_update_mapping(key, value);
+  }
+
+  void remove(std::uint64_t key) {
+    map.remove_mapping(key);
+  }
+};
+
+int main(int argc, char **argv) {
+  std::vector<map_engine> const engines = {
+      {"mutex", &run_map_bench<mutex_adapter>},
+      {"shared_mutex", &run_map_bench<shared_mutex_adapter>},
+      {"striped", &run_map_bench<striped_adapter>},
+      {"flat", &run_map_bench<flat_adapter>},
+      {"split_ordered", &run_map_bench<split_ordered_adapter>},
+      {"filtered", &run_map_bench<filtered_adapter>},
+  };
+  return map_bench_main(engines, argc, argv);
+}
@@ -0,0 +1,400 @@
+/**
+ * @file map_bench.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 并发哈希表的YCSB式基准：键分布 × 读写比例 × 值大小 × 线程数，输出吞吐与延迟分位数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 每种哈希表提供一个适配器(键为std::uint64_t，值为std::string)：
+ *
+ *   struct xxx_adapter {
+ *     bool read(std::uint64_t key, std::string &value);
+ *     void put(std::uint64_t key, std::string const &value);  // 更新与插入
+ *     void remove(std::uint64_t key);
+ *   };
+ *
+ * 然后把run_map_bench<xxx_adapter>登记到map_engine表中交给map_bench_main。
+ *
+ * 负载：先装入records个键(0 .. records - 1)，每个线程执行ops次操作，
+ * 按mix中的百分比选择读/更新/插入/删除，每sample_interval次记录一次耗时。
+ * 插入使用全局递增的新键；其余操作的键由分布决定：
+ * - uniform：在[0, 当前最大键)中均匀选取；
+ * - zipfian：YCSB的ScrambledZipfian，theta = 0.99，排名经FNV散列后对records取模，
+ *   热点键分散在整个键空间；
+ * - latest：按zipfian排名从最新插入的键往回数，越新的键越热。
+ *
+ * 命令行参数(均可用逗号给出多个取值，按笛卡尔积依次运行)：
+ *   --maps=mutex,shared_mutex,...   --threads=1,2,4,8   --records=100000
+ *   --ops=200000(每个线程)   --distribution=uniform,zipfian,latest
+ *   --mix=95:5:0:0,50:50:0:0(读:更新:插入:删除的百分比)
+ *   --value_size=100   --format=csv|json
+ */
+
+#ifndef _MAP_BENCH_H_
+#define _MAP_BENCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "queue_bench.hpp"
+#include "stress.hpp"
+
+struct map_mix {
+  unsigned read;
+  unsigned update;
+  unsigned insert;
+  unsigned remove;
+};
+
+struct map_workload {
+  unsigned    threads;
+  unsigned    records;
+  unsigned    ops;  // 每个线程
+  std::string distribution;
+  map_mix     mix;
+  unsigned    value_size;
+};
+
+struct map_bench_result {
+  double       ops_per_sec;
+  double       read_hit_ratio;
+  std::int64_t p50_ns;
+  std::int64_t p99_ns;
+  std::int64_t p999_ns;
+};
+
+unsigned const map_sample_interval = 16;
+
+// YCSB的ZipfianGenerator(Gray等)，返回[0, items)中的排名，0最热
+class zipfian_generator {
+public:
+  explicit zipfian_generator(std::uint64_t items_, double theta_ = 0.99)
+      : items(items_),
+        theta(theta_),
+        zetan(zeta(items_, theta_)),
+        alpha(1.0 / (1.0 - theta_)),
+        eta((1.0 - std::pow(2.0 / items_, 1.0 - theta_)) /
+            (1.0 - zeta(2, theta_) / zetan)) {
+  }
+
+  // u为[0, 1)中的均匀随机数
+  std::uint64_t next(double u) const {
+    double const uz = u * zetan;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta)) {
+      return 1;
+    }
+    std::uint64_t const rank = static_cast<std::uint64_t>(
+        items * std::pow(eta * u - eta + 1.0, alpha));
+    return std::min(rank, items - 1);
+  }
+
+private:
+  std::uint64_t const items;
+  double const        theta;
+  double const        zetan;
+  double const        alpha;
+  double const        eta;
+
+  static double zeta(std::uint64_t n, double theta) {
+    double sum = 0;
+    for (std::uint64_t i = 1; i <= n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+};
+
+inline std::uint64_t fnv_hash64(std::uint64_t value) {
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  for (int i = 0; i < 8; i++) {
+    hash ^= value & 0xff;
+    hash *= 0x100000001b3ULL;
+    value >>= 8;
+  }
+  return hash;
+}
+
+// 按分布选取已有的键，newest为下一个待插入的键
+class key_chooser {
+public:
+  key_chooser(std::string const &distribution_, unsigned records)
+      : distribution(distribution_), records_count(records), zipf(records) {
+  }
+
+  template <typename Random>
+  std::uint64_t next(Random &random, std::uint64_t newest) const {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (distribution == "zipfian") {
+      return fnv_hash64(zipf.next(unit(random))) % records_count;
+    }
+    if (distribution == "latest") {
+      std::uint64_t const rank = zipf.next(unit(random));
+      return rank < newest ? newest - 1 - rank : 0;
+    }
+    std::uniform_int_distribution<std::uint64_t> any(0, newest - 1);
+    return any(random);
+  }
+
+private:
+  std::string const       distribution;
+  std::uint64_t const     records_count;
+  zipfian_generator const zipf;
+};
+
+template <typename Adapter>
+map_bench_result run_map_bench(map_workload const &workload) {
+  Adapter           map;
+  std::string const initial(workload.value_size, 'i');
+  for (unsigned key = 0; key < workload.records; key++) {
+    map.put(key, initial);
+  }
+
+  key_chooser const                      chooser(workload.distribution,
+                                                 workload.records);
+  std::atomic<std::uint64_t>             newest(workload.records);
+  std::atomic<std::uint64_t>             reads(0);
+  std::atomic<std::uint64_t>             hits(0);
+  start_gate                             gate;
+  std::vector<std::vector<std::int64_t>> latencies(workload.threads);
+  std::vector<std::thread>               workers;
+  for (unsigned t = 0; t < workload.threads; t++) {
+    workers.push_back(std::thread([&, t] {
+      std::mt19937_64                         random(t * 7919 + 1);
+      std::uniform_int_distribution<unsigned> percent(0, 99);
+      std::string const                       value(workload.value_size, 'v');
+      std::string                             out;
+      std::uint64_t                           local_reads = 0;
+      std::uint64_t                           local_hits  = 0;
+      std::vector<std::int64_t>              &samples     = latencies[t];
+      samples.reserve(workload.ops / map_sample_interval + 1);
+      map_mix const &mix = workload.mix;
+      gate.arrive_and_wait();
+      for (unsigned i = 0; i < workload.ops; i++) {
+        unsigned const     p      = percent(random);
+        bool const         sample = i % map_sample_interval == 0;
+        std::int64_t const start  = sample ? bench_now_ns() : 0;
+        if (p < mix.read) {
+          ++local_reads;
+          local_hits += map.read(chooser.next(random, newest.load()), out);
+        } else if (p < mix.read + mix.update) {
+          map.put(chooser.next(random, newest.load()), value);
+        } else if (p < mix.read + mix.update + mix.insert) {
+          map.put(newest.fetch_add(1), value);
+        } else if (p < mix.read + mix.update + mix.insert + mix.remove) {
+          map.remove(chooser.next(random, newest.load()));
+        }
+        if (sample) {
+          samples.push_back(bench_now_ns() - start);
+        }
+      }
+      reads += local_reads;
+      hits += local_hits;
+    }));
+  }
+  auto const start = std::chrono::steady_clock::now();
+  gate.open_when(workload.threads);
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<std::int64_t> all;
+  for (unsigned t = 0; t < workload.threads; t++) {
+    all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+  }
+  auto percentile = [&all](double q) -> std::int64_t {
+    if (all.empty()) {
+      return 0;
+    }
+    std::size_t const k = std::min(all.size() - 1,
+                                   static_cast<std::size_t>(q * all.size()));
+    std::nth_element(all.begin(), all.begin() + k, all.end());
+    return all[k];
+  };
+
+  map_bench_result result;
+  result.ops_per_sec =
+      static_cast<double>(workload.threads) * workload.ops / elapsed.count();
+  result.read_hit_ratio =
+      reads.load() ? static_cast<double>(hits.load()) / reads.load() : 0;
+  result.p50_ns  = percentile(0.50);
+  result.p99_ns  = percentile(0.99);
+  result.p999_ns = percentile(0.999);
+  return result;
+}
+
+struct map_engine {
+  char const *name;
+  map_bench_result (*run)(map_workload const &);
+};
+
+// "95:5:0:0"，缺省的项为0
+inline bool parse_mix(std::string const &text, map_mix &mix) {
+  unsigned    parts[4] = {0, 0, 0, 0};
+  std::size_t begin    = 0;
+  for (unsigned i = 0; i < 4 && begin <= text.size(); i++) {
+    std::size_t const end = std::min(text.find(':', begin), text.size());
+    parts[i]              = static_cast<unsigned>(
+        std::strtoul(text.substr(begin, end - begin).c_str(), 0, 10));
+    begin = end + 1;
+  }
+  mix.read   = parts[0];
+  mix.update = parts[1];
+  mix.insert = parts[2];
+  mix.remove = parts[3];
+  return mix.read + mix.update + mix.insert + mix.remove == 100;
+}
+
+inline int map_bench_main(std::vector<map_engine> const &engines, int argc,
+                          char **argv) {
+  std::vector<std::string> maps;
+  for (std::size_t i = 0; i < engines.size(); i++) {
+    maps.push_back(engines[i].name);
+  }
+  std::vector<unsigned>    threads       = {1, 2, 4, 8};
+  std::vector<std::string> distributions = {"uniform", "zipfian", "latest"};
+  std::vector<std::string> mixes         = {"95:5:0:0", "50:50:0:0",
+                                            "90:0:5:5"};
+  std::vector<unsigned>    value_sizes   = {100};
+  unsigned                 records       = 100000;
+  unsigned                 ops           = 200000;
+  std::string              format        = "csv";
+
+  for (int i = 1; i < argc; i++) {
+    std::string const arg = argv[i];
+    std::size_t const eq  = arg.find('=');
+    std::string const key = arg.substr(0, eq);
+    std::string const value =
+        eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+    if (key == "--maps") {
+      maps = split_list(value);
+    } else if (key == "--threads") {
+      threads = split_unsigned(value);
+    } else if (key == "--records") {
+      records = static_cast<unsigned>(std::strtoul(value.c_str(), 0, 10));
+    } else if (key == "--ops") {
+      ops = static_cast<unsigned>(std::strtoul(value.c_str(), 0, 10));
+    } else if (key == "--distribution") {
+      distributions = split_list(value);
+    } else if (key == "--mix") {
+      mixes = split_list(value);
+    } else if (key == "--value_size") {
+      value_sizes = split_unsigned(value);
+    } else if (key == "--format") {
+      format = value;
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  if (records == 0 || ops == 0) {
+    std::cerr << "records and ops must be positive" << std::endl;
+    return 1;
+  }
+  for (std::size_t i = 0; i < threads.size(); i++) {
+    if (threads[i] == 0) {
+      std::cerr << "thread counts must be positive" << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<map_engine> selected;
+  for (std::size_t i = 0; i < maps.size(); i++) {
+    std::size_t j = 0;
+    while (j < engines.size() && maps[i] != engines[j].name) {
+      j++;
+    }
+    if (j == engines.size()) {
+      std::cerr << "unknown map " << maps[i] << std::endl;
+      return 1;
+    }
+    selected.push_back(engines[j]);
+  }
+  for (std::size_t i = 0; i < distributions.size(); i++) {
+    if (distributions[i] != "uniform" && distributions[i] != "zipfian" &&
+        distributions[i] != "latest") {
+      std::cerr << "unknown distribution " << distributions[i] << std::endl;
+      return 1;
+    }
+  }
+  std::vector<map_mix> parsed(mixes.size());
+  for (std::size_t i = 0; i < mixes.size(); i++) {
+    if (!parse_mix(mixes[i], parsed[i])) {
+      std::cerr << "mix " << mixes[i] << " does not add up to 100"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  bool const json = format == "json";
+  if (json) {
+    std::cout << "[";
+  } else {
+    std::cout << "map,distribution,mix,value_size,threads,records,ops,"
+                 "ops_per_sec,read_hit_ratio,p50_ns,p99_ns,p999_ns"
+              << std::endl;
+  }
+  bool first = true;
+  for (std::size_t m = 0; m < selected.size(); m++) {
+    for (std::size_t d = 0; d < distributions.size(); d++) {
+      for (std::size_t x = 0; x < parsed.size(); x++) {
+        for (unsigned size : value_sizes) {
+          for (unsigned n : threads) {
+            map_workload workload;
+            workload.threads      = n;
+            workload.records      = records;
+            workload.ops          = ops;
+            workload.distribution = distributions[d];
+            workload.mix          = parsed[x];
+            workload.value_size   = size;
+            map_bench_result const result = selected[m].run(workload);
+            if (json) {
+              std::cout << (first ? "\n" : ",\n") << "  {\"map\": \""
+                        << selected[m].name << "\", \"distribution\": \""
+                        << distributions[d] << "\", \"mix\": \"" << mixes[x]
+                        << "\", \"value_size\": " << size
+                        << ", \"threads\": " << n
+                        << ", \"records\": " << records
+                        << ", \"ops\": " << ops
+                        << ", \"ops_per_sec\": " << result.ops_per_sec
+                        << ", \"read_hit_ratio\": " << result.read_hit_ratio
+                        << ", \"p50_ns\": " << result.p50_ns
+                        << ", \"p99_ns\": " << result.p99_ns
+                        << ", \"p999_ns\": " << result.p999_ns << "}";
+            } else {
+              std::cout << selected[m].name << "," << distributions[d] << ","
+                        << mixes[x] << "," << size << "," << n << ","
+                        << records << "," << ops << "," << result.ops_per_sec
+                        << "," << result.read_hit_ratio << ","
+                        << result.p50_ns << "," << result.p99_ns << ","
+                        << result.p999_ns << std::endl;
+            }
+            first = false;
+          }
+        }
+      }
+    }
+  }
+  if (json) {
+    std::cout << "\n]" << std::endl;
+  }
+  return 0;
+}
+
+#endif  // !_MAP_BENCH_H_
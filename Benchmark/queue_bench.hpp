@@ -0,0 +1,365 @@
+/**
+ * @file queue_bench.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 队列基准测试框架：P个生产者 × C个消费者，输出吞吐、交接延迟分位数和每次操作的分配次数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 各队列实现的类名互相冲突(例如多个threadsafe_queue)，因此每种队列
+ * 单独编译成一个queue_bench_xxx可执行文件，只需提供一个适配器：
+ *
+ *   template <typename T>
+ *   struct xxx_adapter {
+ *     void push(T const &value);
+ *     void pop(T &value);  // 阻塞或自旋直到取到元素
+ *   };
+ *
+ * 然后在main中调用queue_bench_main<xxx_adapter>("xxx", argc, argv)。
+ *
+ * 命令行参数(均可用逗号给出多个取值，按笛卡尔积依次运行)：
+ *   --producers=1,4   --consumers=1,4   --items=100000(每个生产者)
+ *   --payload=16,256,4096   --load=steady,burst   --format=csv|json
+ *   --check=1|0(先对每组生产者/消费者数做stress.hpp中的压力测试与线性一致性检查)
+ * 检查结果输出到标准错误，任何一项失败时返回1。
+ */
+
+#ifndef _QUEUE_BENCH_H_
+#define _QUEUE_BENCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "stress.hpp"
+
+// 消息负载：头部携带入队时间戳，其余字节填充到N
+template <std::size_t N>
+struct bench_payload {
+  static_assert(N >= 16, "payload must hold the header");
+  std::int64_t  stamp;  // 入队时的steady_clock纳秒数，-1表示结束标记
+  std::uint64_t seq;
+  char          data[N - 16];
+};
+
+template <>
+struct bench_payload<16> {
+  std::int64_t  stamp;
+  std::uint64_t seq;
+};
+
+struct bench_config {
+  unsigned producers;
+  unsigned consumers;
+  unsigned items;  // 每个生产者
+  unsigned payload;
+  bool     burst;
+};
+
+struct bench_result {
+  double       ops_per_sec;
+  std::int64_t p50_ns;
+  std::int64_t p99_ns;
+  std::int64_t p999_ns;
+  double       allocs_per_op;
+  std::size_t  delivered;  // 消费者实际取到的元素数，应等于生产总数
+};
+
+// burst模式下每批连续入队的条数和批次间的空闲时间
+unsigned const burst_size     = 1024;
+unsigned const burst_pause_us = 100;
+
+inline std::int64_t bench_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+template <template <typename> class Adapter, typename Payload>
+bench_result run_queue_bench(bench_config const &config) {
+  Adapter<Payload>           queue;
+  std::atomic<std::uint64_t> allocations(0);
+  std::atomic<unsigned>      ready(0);
+  std::atomic<bool>          go(false);
+  std::vector<std::vector<std::int64_t>> latencies(config.consumers);
+  drain_monitor                          drained(config.consumers);
+  std::vector<std::thread>               threads;
+
+  auto wait_for_start = [&ready, &go] {
+    ++ready;
+    while (!go.load()) {
+      std::this_thread::yield();
+    }
+  };
+
+  for (unsigned p = 0; p < config.producers; p++) {
+    threads.push_back(std::thread([&, p] {
+      Payload item;
+      std::memset(&item, 0, sizeof(item));
+      wait_for_start();
+      std::uint64_t const before = thread_allocations();
+      for (unsigned i = 0; i < config.items; i++) {
+        item.stamp = bench_now_ns();
+        item.seq   = (static_cast<std::uint64_t>(p) << 32) | i;
+        queue.push(item);
+        if (config.burst && (i + 1) % burst_size == 0) {
+          std::this_thread::sleep_for(
+              std::chrono::microseconds(burst_pause_us));
+        }
+      }
+      allocations += thread_allocations() - before;
+    }));
+  }
+
+  std::size_t const expected =
+      static_cast<std::size_t>(config.producers) * config.items;
+  for (unsigned c = 0; c < config.consumers; c++) {
+    threads.push_back(std::thread([&, c] {
+      // 单个消费者可能取走全部元素，按总数预留，
+      // 计数期间扩容的分配不会算到被测队列头上
+      std::vector<std::int64_t> &samples = latencies[c];
+      samples.reserve(expected);
+      Payload item;
+      wait_for_start();
+      std::uint64_t const before = thread_allocations();
+      for (;;) {
+        queue.pop(item);
+        if (item.stamp < 0) {
+          break;
+        }
+        samples.push_back(bench_now_ns() - item.stamp);
+        drained.popped(c);
+      }
+      allocations += thread_allocations() - before;
+    }));
+  }
+
+  unsigned const total_threads = config.producers + config.consumers;
+  while (ready.load() < total_threads) {
+    std::this_thread::yield();
+  }
+  auto const start = std::chrono::steady_clock::now();
+  go               = true;
+  for (unsigned p = 0; p < config.producers; p++) {
+    threads[p].join();
+  }
+  // 所有元素都被取走后，再为每个消费者投递一个结束标记
+  drained.wait(expected);
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  Payload stop;
+  std::memset(&stop, 0, sizeof(stop));
+  stop.stamp = -1;
+  for (unsigned c = 0; c < config.consumers; c++) {
+    queue.push(stop);
+  }
+  for (unsigned i = config.producers; i < total_threads; i++) {
+    threads[i].join();
+  }
+
+  std::vector<std::int64_t> all;
+  all.reserve(expected);
+  for (unsigned c = 0; c < config.consumers; c++) {
+    all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+  }
+  auto percentile = [&all](double q) -> std::int64_t {
+    if (all.empty()) {
+      return 0;
+    }
+    std::size_t const k = std::min(all.size() - 1,
+                                   static_cast<std::size_t>(q * all.size()));
+    std::nth_element(all.begin(), all.begin() + k, all.end());
+    return all[k];
+  };
+
+  bench_result result;
+  result.ops_per_sec   = expected / elapsed.count();
+  result.p50_ns        = percentile(0.50);
+  result.p99_ns        = percentile(0.99);
+  result.p999_ns       = percentile(0.999);
+  result.allocs_per_op = static_cast<double>(allocations.load()) / expected;
+  result.delivered     = all.size();
+  return result;
+}
+
+template <template <typename> class Adapter>
+bool run_queue_bench(bench_config const &config, bench_result &result) {
+  switch (config.payload) {
+    case 16:
+      result = run_queue_bench<Adapter, bench_payload<16>>(config);
+      return true;
+    case 64:
+      result = run_queue_bench<Adapter, bench_payload<64>>(config);
+      return true;
+    case 256:
+      result = run_queue_bench<Adapter, bench_payload<256>>(config);
+      return true;
+    case 1024:
+      result = run_queue_bench<Adapter, bench_payload<1024>>(config);
+      return true;
+    case 4096:
+      result = run_queue_bench<Adapter, bench_payload<4096>>(config);
+      return true;
+    case 16384:
+      result = run_queue_bench<Adapter, bench_payload<16384>>(config);
+      return true;
+    default:
+      return false;
+  }
+}
+
+inline std::vector<std::string> split_list(std::string const &value) {
+  std::vector<std::string> res;
+  std::stringstream        ss(value);
+  std::string              item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      res.push_back(item);
+    }
+  }
+  return res;
+}
+
+inline std::vector<unsigned> split_unsigned(std::string const &value) {
+  std::vector<unsigned> res;
+  for (std::string const &item : split_list(value)) {
+    res.push_back(static_cast<unsigned>(std::strtoul(item.c_str(), 0, 10)));
+  }
+  return res;
+}
+
+inline bool report_queue_check(char const *name, char const *check,
+                               unsigned producers, unsigned consumers,
+                               check_result const &result) {
+  std::cerr << name << ": " << check << " producers=" << producers
+            << " consumers=" << consumers << " "
+            << (result.ok ? "ok" : "FAILED") << " (" << result.message << ")"
+            << std::endl;
+  return result.ok;
+}
+
+template <template <typename> class Adapter>
+int queue_bench_main(char const *name, int argc, char **argv) {
+  std::vector<unsigned>    producers = {1, 4};
+  std::vector<unsigned>    consumers = {1, 4};
+  std::vector<unsigned>    payloads  = {16, 256, 4096};
+  std::vector<std::string> loads     = {"steady", "burst"};
+  unsigned                 items     = 100000;
+  std::string              format    = "csv";
+  bool                     check     = true;
+
+  for (int i = 1; i < argc; i++) {
+    std::string const arg = argv[i];
+    std::size_t const eq  = arg.find('=');
+    std::string const key = arg.substr(0, eq);
+    std::string const value =
+        eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+    if (key == "--producers") {
+      producers = split_unsigned(value);
+    } else if (key == "--consumers") {
+      consumers = split_unsigned(value);
+    } else if (key == "--payload") {
+      payloads = split_unsigned(value);
+    } else if (key == "--load") {
+      loads = split_list(value);
+    } else if (key == "--items") {
+      items = static_cast<unsigned>(std::strtoul(value.c_str(), 0, 10));
+    } else if (key == "--format") {
+      format = value;
+    } else if (key == "--check") {
+      check = value != "0";
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  bool ok = true;
+  if (check) {
+    for (unsigned p : producers) {
+      for (unsigned c : consumers) {
+        ok = report_queue_check(name, "stress", p, c,
+                                stress_queue<Adapter>(p, c, items)) &&
+             ok;
+        if (is_relaxed_fifo<Adapter<std::uint64_t>>::value) {
+          continue;
+        }
+        unsigned const lp = std::min(p, 2u);
+        unsigned const lc = std::min(c, 2u);
+        ok = report_queue_check(name, "linearizable", lp, lc,
+                                linearize_queue<Adapter>(lp, lc, 4, 200)) &&
+             ok;
+      }
+    }
+  }
+
+  bool const json = format == "json";
+  if (json) {
+    std::cout << "[";
+  } else {
+    std::cout << "queue,producers,consumers,payload,load,items,ops_per_sec,"
+                 "p50_ns,p99_ns,p999_ns,allocs_per_op"
+              << std::endl;
+  }
+  bool first = true;
+  for (unsigned p : producers) {
+    for (unsigned c : consumers) {
+      for (unsigned size : payloads) {
+        for (std::string const &load : loads) {
+          bench_config config;
+          config.producers = p;
+          config.consumers = c;
+          config.items     = items;
+          config.payload   = size;
+          config.burst     = load == "burst";
+          bench_result result;
+          if (!run_queue_bench<Adapter>(config, result)) {
+            std::cerr << "unsupported payload " << size << std::endl;
+            return 1;
+          }
+          if (result.delivered != std::size_t(p) * items) {
+            std::cerr << name << ": producers=" << p << " consumers=" << c
+                      << " delivered " << result.delivered << " of "
+                      << std::size_t(p) * items << " items" << std::endl;
+            ok = false;
+          }
+          if (json) {
+            std::cout << (first ? "\n" : ",\n") << "  {\"queue\": \"" << name
+                      << "\", \"producers\": " << p << ", \"consumers\": " << c
+                      << ", \"payload\": " << size << ", \"load\": \"" << load
+                      << "\", \"items\": " << items
+                      << ", \"ops_per_sec\": " << result.ops_per_sec
+                      << ", \"p50_ns\": " << result.p50_ns
+                      << ", \"p99_ns\": " << result.p99_ns
+                      << ", \"p999_ns\": " << result.p999_ns
+                      << ", \"allocs_per_op\": " << result.allocs_per_op
+                      << "}";
+          } else {
+            std::cout << name << "," << p << "," << c << "," << size << ","
+                      << load << "," << items << "," << result.ops_per_sec
+                      << "," << result.p50_ns << "," << result.p99_ns << ","
+                      << result.p999_ns << "," << result.allocs_per_op
+                      << std::endl;
+          }
+          first = false;
+        }
+      }
+    }
+  }
+  if (json) {
+    std::cout << "\n]" << std::endl;
+  }
+  return ok ? 0 : 1;
+}
+
+#endif  // !_QUEUE_BENCH_H_
@@ -0,0 +1,34 @@
+/**
+ * @file queue_bench_bounded_ring.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/bounded_ring_queue.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ConArch/bounded_ring_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct bounded_ring_adapter {
+  bounded_ring_queue<T> queue;
+
+  bounded_ring_adapter() : queue(1024) {
+  }
+
+  void push(T const &value) {
+    queue.emplace(value);
+  }
+
+  void pop(T &value) {
+    queue.wait_and_pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<bounded_ring_adapter>("bounded_ring_queue", argc,
+                                                argv);
+}
@@ -0,0 +1,31 @@
+/**
+ * @file queue_bench_chapter09.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief Chapter09/threadsafe_queue.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Chapter09/threadsafe_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct chapter09_adapter {
+  threadsafe_queue<T> queue;
+
+  void push(T const &value) {
+    queue.push(value);
+  }
+
+  void pop(T &value) {
+    queue.wait_and_pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<chapter09_adapter>("chapter09_threadsafe_queue", argc,
+                                             argv);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file queue_bench_cppmem.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief CppMem/thread_safe_queue.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "CppMem/thread_safe_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct cppmem_adapter {
+  thread_safe_queue<T> queue;
+
+  void push(T const &value) {
+    T copy = value;
+    queue.push(copy);
+  }
+
+  void pop(T &value) {
+    queue.wait_and_pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<cppmem_adapter>("cppmem_thread_safe_queue", argc,
+                                          argv);
+}
@@ -0,0 +1,38 @@
+/**
+ * @file queue_bench_design.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief design/threadsafe_queue.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <thread>
+
+#include "design/threadsafe_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct design_adapter {
+  threadsafe_queue<T> queue;
+
+  void push(T const &value) {
+    queue.push(value);
+  }
+
+  // 该队列没有等待接口，只能轮询try_pop
+  void pop(T &value) {
+    std::shared_ptr<T> res;
+    while (!(res = queue.try_pop())) {
+      std::this_thread::yield();
+    }
+    value = *res;
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<design_adapter>("design_threadsafe_queue", argc,
+                                          argv);
+}
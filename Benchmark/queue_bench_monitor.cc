@@ -0,0 +1,30 @@
+/**
+ * @file queue_bench_monitor.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/monitor_queue.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ConArch/monitor_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct monitor_adapter {
+  ThreadSafeQueue<T> queue;
+
+  void push(T const &value) {
+    queue.add(value);
+  }
+
+  void pop(T &value) {
+    value = queue.get();
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<monitor_adapter>("monitor_queue", argc, argv);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file queue_bench_queue_wait.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief design/queue_wait.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "design/queue_wait.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct queue_wait_adapter {
+  threadsafe_queue<T> queue;
+
+  void push(T const &value) {
+    queue.push(value);
+  }
+
+  void pop(T &value) {
+    queue.wait_and_pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<queue_wait_adapter>("design_queue_wait", argc, argv);
+}
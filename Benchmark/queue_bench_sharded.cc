@@ -0,0 +1,32 @@
+/**
+ * @file queue_bench_sharded.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief Chapter09/sharded_queue.hpp 的基准测试
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Chapter09/sharded_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct sharded_adapter {
+  typedef void relaxed_fifo;  // 只保证同一生产者内FIFO
+
+  sharded_queue<T> queue;
+
+  void push(T const &value) {
+    queue.push(value);
+  }
+
+  void pop(T &value) {
+    queue.wait_and_pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return queue_bench_main<sharded_adapter>("sharded_queue", argc, argv);
+}
@@ -0,0 +1,47 @@
+/**
+ * @file queue_bench_spsc.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/singon_product_queue.hpp(单生产者单消费者)的测试与基准
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 默认只跑1个生产者、1个消费者，命令行参数仍可覆盖。
+ */
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConArch/singon_product_queue.hpp"
+#include "queue_bench.hpp"
+
+template <typename T>
+struct spsc_adapter {
+  single_lock_queue<T> queue;
+
+  void push(T const &value) {
+    queue.push(value);
+  }
+
+  void pop(T &value) {
+    std::shared_ptr<T> res;
+    while (!(res = queue.pop())) {
+      std::this_thread::yield();
+    }
+    value = *res;
+  }
+};
+
+int main(int argc, char **argv) {
+  std::string         producers("--producers=1");
+  std::string         consumers("--consumers=1");
+  std::vector<char *> args(argv, argv + 1);
+  args.push_back(&producers[0]);
+  args.push_back(&consumers[0]);
+  args.insert(args.end(), argv + 1, argv + argc);
+  return queue_bench_main<spsc_adapter>(
+      "single_lock_queue", static_cast<int>(args.size()), args.data());
+}
@@ -0,0 +1,192 @@
+/**
+ * @file stack_bench.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 栈的测试框架：压力测试 + 线性一致性检查 + 吞吐与单次操作延迟分位数
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 与queue_bench.hpp相同，各栈实现的类名互相冲突，每种栈单独编译成一个
+ * stack_bench_xxx可执行文件，提供stress.hpp中描述的栈适配器，
+ * 然后在main中调用stack_bench_main<xxx_adapter>("xxx", argc, argv)。
+ *
+ * 基准负载：栈中预先放入prefill个元素，每个线程交替push与try_pop，
+ * 每sample_interval次操作记录一次该操作的耗时。
+ *
+ * 命令行参数：
+ *   --threads=1,2,4,8   --ops=200000(每个线程)   --check=1|0   --format=csv|json
+ * 检查结果输出到标准错误，任何一项失败时返回1。
+ */
+
+#ifndef _STACK_BENCH_H_
+#define _STACK_BENCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alloc_counter.hpp"
+#include "queue_bench.hpp"
+#include "stress.hpp"
+
+struct stack_bench_result {
+  double       ops_per_sec;
+  std::int64_t p50_ns;
+  std::int64_t p99_ns;
+  std::int64_t p999_ns;
+  double       allocs_per_op;
+};
+
+unsigned const stack_prefill         = 1024;
+unsigned const stack_sample_interval = 16;
+
+template <template <typename> class Adapter>
+stack_bench_result run_stack_bench(unsigned threads, unsigned ops) {
+  Adapter<std::uint64_t> stack;
+  for (unsigned i = 0; i < stack_prefill; i++) {
+    stack.push(i);
+  }
+  start_gate                             gate;
+  std::atomic<std::uint64_t>             allocations(0);
+  std::vector<std::vector<std::int64_t>> latencies(threads);
+  std::vector<std::thread>               workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&, t] {
+      std::vector<std::int64_t> &samples = latencies[t];
+      samples.reserve(ops / stack_sample_interval + 1);
+      std::uint64_t value = 0;
+      gate.arrive_and_wait();
+      std::uint64_t const before = thread_allocations();
+      for (unsigned i = 0; i < ops; i++) {
+        bool const         sample = i % stack_sample_interval == 0;
+        std::int64_t const start  = sample ? bench_now_ns() : 0;
+        if (i % 2 == 0) {
+          stack.push(value);
+        } else {
+          stack.try_pop(value);
+        }
+        if (sample) {
+          samples.push_back(bench_now_ns() - start);
+        }
+      }
+      allocations += thread_allocations() - before;
+    }));
+  }
+  auto const start = std::chrono::steady_clock::now();
+  gate.open_when(threads);
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<std::int64_t> all;
+  for (unsigned t = 0; t < threads; t++) {
+    all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+  }
+  auto percentile = [&all](double q) -> std::int64_t {
+    if (all.empty()) {
+      return 0;
+    }
+    std::size_t const k = std::min(all.size() - 1,
+                                   static_cast<std::size_t>(q * all.size()));
+    std::nth_element(all.begin(), all.begin() + k, all.end());
+    return all[k];
+  };
+
+  double const       total = static_cast<double>(threads) * ops;
+  stack_bench_result result;
+  result.ops_per_sec   = total / elapsed.count();
+  result.p50_ns        = percentile(0.50);
+  result.p99_ns        = percentile(0.99);
+  result.p999_ns       = percentile(0.999);
+  result.allocs_per_op = allocations.load() / total;
+  return result;
+}
+
+inline bool report_check(char const *name, char const *check,
+                         unsigned threads, check_result const &result) {
+  std::cerr << name << ": " << check << " threads=" << threads << " "
+            << (result.ok ? "ok" : "FAILED") << " (" << result.message << ")"
+            << std::endl;
+  return result.ok;
+}
+
+template <template <typename> class Adapter>
+int stack_bench_main(char const *name, int argc, char **argv) {
+  std::vector<unsigned> threads = {1, 2, 4, 8};
+  unsigned              ops     = 200000;
+  bool                  check   = true;
+  std::string           format  = "csv";
+
+  for (int i = 1; i < argc; i++) {
+    std::string const arg = argv[i];
+    std::size_t const eq  = arg.find('=');
+    std::string const key = arg.substr(0, eq);
+    std::string const value =
+        eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+    if (key == "--threads") {
+      threads = split_unsigned(value);
+    } else if (key == "--ops") {
+      ops = static_cast<unsigned>(std::strtoul(value.c_str(), 0, 10));
+    } else if (key == "--check") {
+      check = value != "0";
+    } else if (key == "--format") {
+      format = value;
+    } else {
+      std::cerr << "unknown option " << arg << std::endl;
+      return 1;
+    }
+  }
+
+  bool ok = true;
+  if (check) {
+    for (unsigned n : threads) {
+      ok = report_check(name, "stress", n, stress_stack<Adapter>(n, ops)) &&
+           ok;
+    }
+    ok = report_check(name, "linearizable", 3,
+                      linearize_stack<Adapter>(3, 6, 500)) &&
+         ok;
+  }
+
+  bool const json = format == "json";
+  if (json) {
+    std::cout << "[";
+  } else {
+    std::cout << "stack,threads,ops,ops_per_sec,p50_ns,p99_ns,p999_ns,"
+                 "allocs_per_op"
+              << std::endl;
+  }
+  bool first = true;
+  for (unsigned n : threads) {
+    stack_bench_result const result = run_stack_bench<Adapter>(n, ops);
+    if (json) {
+      std::cout << (first ? "\n" : ",\n") << "  {\"stack\": \"" << name
+                << "\", \"threads\": " << n << ", \"ops\": " << ops
+                << ", \"ops_per_sec\": " << result.ops_per_sec
+                << ", \"p50_ns\": " << result.p50_ns
+                << ", \"p99_ns\": " << result.p99_ns
+                << ", \"p999_ns\": " << result.p999_ns
+                << ", \"allocs_per_op\": " << result.allocs_per_op << "}";
+    } else {
+      std::cout << name << "," << n << "," << ops << "," << result.ops_per_sec
+                << "," << result.p50_ns << "," << result.p99_ns << ","
+                << result.p999_ns << "," << result.allocs_per_op << std::endl;
+    }
+    first = false;
+  }
+  if (json) {
+    std::cout << "\n]" << std::endl;
+  }
+  return ok ? 0 : 1;
+}
+
+#endif  // !_STACK_BENCH_H_
@@ -0,0 +1,38 @@
+/**
+ * @file stack_bench_hazard_pointer.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/hazard_pointer_stack.hpp的测试与基准
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <memory>
+
+#include "ConArch/hazard_pointer_stack.hpp"
+#include "stack_bench.hpp"
+
+template <typename T>
+struct hazard_pointer_stack_adapter {
+  hazard_pointer_stack<T> stack;
+
+  void push(T const &value) {
+    stack.push(value);
+  }
+
+  bool try_pop(T &value) {
+    std::shared_ptr<T> const res = stack.pop();
+    if (!res) {
+      return false;
+    }
+    value = *res;
+    return true;
+  }
+};
+
+int main(int argc, char **argv) {
+  return stack_bench_main<hazard_pointer_stack_adapter>("hazard_pointer_stack",
+                                                        argc, argv);
+}
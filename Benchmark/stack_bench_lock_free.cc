@@ -0,0 +1,30 @@
+/**
+ * @file stack_bench_lock_free.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/lock_free_stack.hpp(双计数 + 消除数组)的测试与基准
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ConArch/lock_free_stack.hpp"
+#include "stack_bench.hpp"
+
+template <typename T>
+struct lock_free_adapter {
+  lock_free_stack<T> stack;
+
+  void push(T const &value) {
+    stack.push(value);
+  }
+
+  bool try_pop(T &value) {
+    return stack.pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return stack_bench_main<lock_free_adapter>("lock_free_stack", argc, argv);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file stack_bench_mutex.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ThreadDemo/thread_safe_stack.hpp(一把互斥锁)的测试与基准，作为无锁栈的对照
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ThreadDemo/thread_safe_stack.hpp"
+#include "stack_bench.hpp"
+
+template <typename T>
+struct mutex_adapter {
+  thread_safe_stack<T> stack;
+
+  void push(T const &value) {
+    stack.push(value);
+  }
+
+  bool try_pop(T &value) {
+    return stack.try_pop(value);
+  }
+};
+
+int main(int argc, char **argv) {
+  return stack_bench_main<mutex_adapter>("thread_safe_stack", argc, argv);
+}
@@ -0,0 +1,38 @@
+/**
+ * @file stack_bench_nomutex.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/threadsafe_nomutex_stack.hpp(pop计数回收)的测试与基准
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <memory>
+
+#include "ConArch/threadsafe_nomutex_stack.hpp"
+#include "stack_bench.hpp"
+
+template <typename T>
+struct nomutex_adapter {
+  lock_free_stack<T> stack;
+
+  void push(T const &value) {
+    stack.push(value);
+  }
+
+  bool try_pop(T &value) {
+    std::shared_ptr<T> const res = stack.pop();
+    if (!res) {
+      return false;
+    }
+    value = *res;
+    return true;
+  }
+};
+
+int main(int argc, char **argv) {
+  return stack_bench_main<nomutex_adapter>("threadsafe_nomutex_stack", argc,
+                                           argv);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file stack_bench_reclaimer.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief ConArch/lock_free_memory.hpp在两种回收策略下的测试与基准
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string>
+
+#include "ConArch/lock_free_memory.hpp"
+#include "stack_bench.hpp"
+
+template <typename T>
+struct hazard_pointer_adapter {
+  lock_free_stack<T, hazard_pointer_reclaimer> stack;
+
+  void push(T const &value) {
+    stack.push(value);
+  }
+
+  bool try_pop(T &value) {
+    return stack.pop(value);
+  }
+};
+
+template <typename T>
+struct epoch_adapter {
+  lock_free_stack<T, epoch_reclaimer> stack;
+
+  void push(T const &value) {
+    stack.push(value);
+  }
+
+  bool try_pop(T &value) {
+    return stack.pop(value);
+  }
+};
+
+// --reclaimer=hazard|epoch，默认为hazard
+int main(int argc, char **argv) {
+  std::string const   option = "--reclaimer=";
+  std::string         reclaimer("hazard");
+  std::vector<char *> args(argv, argv + argc);
+  for (std::size_t i = 1; i < args.size(); i++) {
+    std::string const arg = args[i];
+    if (arg.compare(0, option.size(), option) == 0) {
+      reclaimer = arg.substr(option.size());
+      args.erase(args.begin() + i);
+      break;
+    }
+  }
+  int const count = static_cast<int>(args.size());
+  if (reclaimer == "epoch") {
+    return stack_bench_main<epoch_adapter>("epoch_reclaimer_stack", count,
+                                           args.data());
+  }
+  return stack_bench_main<hazard_pointer_adapter>("hazard_reclaimer_stack",
+                                                  count, args.data());
+}
@@ -0,0 +1,540 @@
+/**
+ * @file stress.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 栈与队列的多线程随机压力测试、操作历史记录与线性一致性检查
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 栈适配器：
+ *
+ *   template <typename T>
+ *   struct xxx_adapter {
+ *     void push(T const &value);
+ *     bool try_pop(T &value);  // 为空时返回false
+ *   };
+ *
+ * 队列适配器与queue_bench.hpp相同(push + 阻塞的pop)，
+ * 只保证同一生产者内FIFO的松弛队列在适配器中声明typedef void relaxed_fifo。
+ *
+ * - stress_stack/stress_queue：多线程随机操作，结束后检查每个元素恰好出栈/出队一次，
+ *   队列还检查同一生产者的元素按push顺序出队；
+ * - history：每个线程记录操作的调用与返回时刻(全局逻辑时钟)；
+ * - check_linearizable：Wing & Gong回溯搜索一个与实时顺序相容、
+ *   且符合顺序语义的线性化顺序，访问过的(已线性化集合, 模型状态)记入备忘，
+ *   只适合每轮几十个操作的短历史，因此linearize_stack/linearize_queue跑很多短轮次。
+ */
+
+#ifndef _STRESS_H_
+#define _STRESS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct check_result {
+  bool        ok;
+  std::string message;  // 失败原因或统计信息
+};
+
+// 线程私有的xorshift随机数
+class stress_random {
+public:
+  explicit stress_random(std::uint32_t seed) : state(seed * 2654435761u + 1) {
+  }
+
+  std::uint32_t next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+private:
+  std::uint32_t state;
+};
+
+// 所有线程都就绪后同时开始
+class start_gate {
+public:
+  start_gate() : ready(0), go(false) {
+  }
+
+  void arrive_and_wait() {
+    ++ready;
+    while (!go.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  void open_when(unsigned threads) {
+    while (ready.load() < threads) {
+      std::this_thread::yield();
+    }
+    go.store(true);
+  }
+
+private:
+  std::atomic<unsigned> ready;
+  std::atomic<bool>     go;
+};
+
+// 元素编码为(线程号 << 32) | 序号
+inline std::uint64_t stress_value(unsigned thread, std::uint64_t seq) {
+  return (static_cast<std::uint64_t>(thread) << 32) | seq;
+}
+
+// 检查taken恰好是每个线程0..pushed[t]-1的全部元素
+inline check_result check_exactly_once(
+    std::vector<std::uint64_t> taken, std::vector<std::uint64_t> const &pushed) {
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i < pushed.size(); i++) {
+    total += pushed[i];
+  }
+  std::sort(taken.begin(), taken.end());
+  for (std::size_t i = 0; i < taken.size(); i++) {
+    std::uint64_t const thread = taken[i] >> 32;
+    std::uint64_t const seq    = taken[i] & 0xffffffffu;
+    if (thread >= pushed.size() || seq >= pushed[thread]) {
+      std::ostringstream out;
+      out << "value " << taken[i] << " was never pushed";
+      return check_result{false, out.str()};
+    }
+    if (i > 0 && taken[i] == taken[i - 1]) {
+      std::ostringstream out;
+      out << "value " << taken[i] << " taken twice";
+      return check_result{false, out.str()};
+    }
+  }
+  if (taken.size() != total) {
+    std::ostringstream out;
+    out << taken.size() << " of " << total << " values taken";
+    return check_result{false, out.str()};
+  }
+  std::ostringstream out;
+  out << total << " values";
+  return check_result{true, out.str()};
+}
+
+// 每个线程随机push或try_pop，结束后把剩余元素全部弹出
+template <template <typename> class Adapter>
+check_result stress_stack(unsigned threads, unsigned ops) {
+  Adapter<std::uint64_t>                  stack;
+  start_gate                              gate;
+  std::vector<std::uint64_t>              pushed(threads);
+  std::vector<std::vector<std::uint64_t>> popped(threads);
+  std::vector<std::thread>                workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&, t] {
+      stress_random random(t + 1);
+      std::uint64_t seq = 0;
+      std::uint64_t value;
+      gate.arrive_and_wait();
+      for (unsigned i = 0; i < ops; i++) {
+        std::uint32_t const r = random.next();
+        if (r % 2 == 0) {
+          stack.push(stress_value(t, seq++));
+        } else if (stack.try_pop(value)) {
+          popped[t].push_back(value);
+        }
+        if (r % 256 == 1) {
+          std::this_thread::yield();
+        }
+      }
+      pushed[t] = seq;
+    }));
+  }
+  gate.open_when(threads);
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  std::vector<std::uint64_t> taken;
+  for (unsigned t = 0; t < threads; t++) {
+    taken.insert(taken.end(), popped[t].begin(), popped[t].end());
+  }
+  std::uint64_t value;
+  while (stack.try_pop(value)) {
+    taken.push_back(value);
+  }
+  return check_exactly_once(taken, pushed);
+}
+
+// 消费者各自累计取走的元素数，主线程汇总，等队列取空后才投递结束标记。
+// 松弛队列的pop不按全局顺序，结束标记可能先于其他分片中的元素被取到，
+// 因此不能在生产者结束后立即投递
+class drain_monitor {
+public:
+  explicit drain_monitor(unsigned consumers)
+      : counters(new counter[consumers]), size(consumers) {
+    for (unsigned c = 0; c < size; c++) {
+      counters[c].popped.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // 只由消费者c调用
+  void popped(unsigned c) {
+    std::atomic<std::uint64_t> &popped = counters[c].popped;
+    popped.store(popped.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+  }
+
+  std::uint64_t total() const {
+    std::uint64_t res = 0;
+    for (unsigned c = 0; c < size; c++) {
+      res += counters[c].popped.load(std::memory_order_acquire);
+    }
+    return res;
+  }
+
+  // 等到合计取走expected个元素；计数停止增长超过stall时放弃，
+  // 由调用方按缺失的元素报告。轮询间隔内睡眠，不与被测线程争用CPU
+  bool wait(std::uint64_t expected,
+            std::chrono::milliseconds stall = std::chrono::seconds(2)) const {
+    std::uint64_t last     = total();
+    auto          progress = std::chrono::steady_clock::now();
+    while (last < expected) {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+      std::uint64_t const now_popped = total();
+      auto const          now        = std::chrono::steady_clock::now();
+      if (now_popped != last) {
+        last     = now_popped;
+        progress = now;
+      } else if (now - progress > stall) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  struct counter {
+    std::atomic<std::uint64_t> popped;
+    char                       padding[64];
+  };
+
+  std::unique_ptr<counter[]> const counters;
+  unsigned const                   size;
+};
+
+// 生产者各push items个元素，消费者阻塞pop直到收到结束标记，
+// 结束标记在队列取空后才投递
+template <template <typename> class Adapter>
+check_result stress_queue(unsigned producers, unsigned consumers,
+                          unsigned items) {
+  std::uint64_t const stop = ~std::uint64_t(0);
+
+  Adapter<std::uint64_t>                  queue;
+  start_gate                              gate;
+  std::atomic<bool>                       ordered(true);
+  std::vector<std::vector<std::uint64_t>> popped(consumers);
+  drain_monitor                           drained(consumers);
+  std::vector<std::thread>                workers;
+  for (unsigned p = 0; p < producers; p++) {
+    workers.push_back(std::thread([&, p] {
+      stress_random random(p + 1);
+      gate.arrive_and_wait();
+      for (unsigned i = 0; i < items; i++) {
+        queue.push(stress_value(p, i));
+        if (random.next() % 256 == 0) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+  for (unsigned c = 0; c < consumers; c++) {
+    workers.push_back(std::thread([&, c] {
+      // 同一生产者的元素在每个消费者看来都应递增
+      std::vector<std::uint64_t> next_seq(producers, 0);
+      std::uint64_t              value;
+      gate.arrive_and_wait();
+      for (;;) {
+        queue.pop(value);
+        if (value == stop) {
+          break;
+        }
+        popped[c].push_back(value);
+        drained.popped(c);
+        std::uint64_t const producer = value >> 32;
+        std::uint64_t const seq      = value & 0xffffffffu;
+        if (producer < producers) {
+          if (seq < next_seq[producer]) {
+            ordered.store(false);
+          }
+          next_seq[producer] = seq + 1;
+        }
+      }
+    }));
+  }
+  gate.open_when(producers + consumers);
+  for (unsigned p = 0; p < producers; p++) {
+    workers[p].join();
+  }
+  drained.wait(static_cast<std::uint64_t>(producers) * items);
+  for (unsigned c = 0; c < consumers; c++) {
+    queue.push(stop);
+  }
+  for (std::size_t i = producers; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  std::vector<std::uint64_t> taken;
+  for (unsigned c = 0; c < consumers; c++) {
+    taken.insert(taken.end(), popped[c].begin(), popped[c].end());
+  }
+  check_result result =
+      check_exactly_once(taken, std::vector<std::uint64_t>(producers, items));
+  if (result.ok && !ordered.load()) {
+    return check_result{false, "per-producer order violated"};
+  }
+  return result;
+}
+
+enum operation_kind { operation_push, operation_pop };
+
+struct operation {
+  operation_kind kind;
+  std::uint64_t  value;
+  bool           ok;        // pop是否取到元素
+  std::uint64_t  invoked;   // 调用时刻
+  std::uint64_t  returned;  // 返回时刻
+};
+
+// 每个线程只写自己的日志，逻辑时钟给出调用与返回的全序
+class history {
+public:
+  explicit history(unsigned threads) : logs(threads), clock(0) {
+  }
+
+  std::uint64_t invoke() {
+    return clock.fetch_add(1);
+  }
+
+  void complete(unsigned thread, operation_kind kind, std::uint64_t value,
+                bool ok, std::uint64_t invoked) {
+    operation const op = {kind, value, ok, invoked, clock.fetch_add(1)};
+    logs[thread].push_back(op);
+  }
+
+  std::vector<operation> operations() const {
+    std::vector<operation> res;
+    for (std::size_t i = 0; i < logs.size(); i++) {
+      res.insert(res.end(), logs[i].begin(), logs[i].end());
+    }
+    return res;
+  }
+
+private:
+  std::vector<std::vector<operation>> logs;
+  std::atomic<std::uint64_t>          clock;
+};
+
+// 顺序栈：pop取到的必须是栈顶，取空时栈必须为空
+struct stack_model {
+  static bool apply(operation const &op, std::vector<std::uint64_t> &state) {
+    if (op.kind == operation_push) {
+      state.push_back(op.value);
+      return true;
+    }
+    if (!op.ok) {
+      return state.empty();
+    }
+    if (state.empty() || state.back() != op.value) {
+      return false;
+    }
+    state.pop_back();
+    return true;
+  }
+};
+
+// 顺序队列：阻塞pop不会在空队列上返回
+struct queue_model {
+  static bool apply(operation const &op, std::vector<std::uint64_t> &state) {
+    if (op.kind == operation_push) {
+      state.push_back(op.value);
+      return true;
+    }
+    if (!op.ok) {
+      return state.empty();
+    }
+    if (state.empty() || state.front() != op.value) {
+      return false;
+    }
+    state.erase(state.begin());
+    return true;
+  }
+};
+
+template <typename Model>
+class linearizability_checker {
+public:
+  explicit linearizability_checker(std::vector<operation> const &ops_)
+      : ops(ops_) {
+    assert(ops.size() <= 64);
+  }
+
+  bool check() {
+    std::vector<std::uint64_t> state;
+    return search(0, state);
+  }
+
+private:
+  typedef std::pair<std::uint64_t, std::vector<std::uint64_t>> search_state;
+
+  std::vector<operation> const ops;
+  std::set<search_state>       visited;
+
+  bool search(std::uint64_t done, std::vector<std::uint64_t> const &state) {
+    if (done == all_done()) {
+      return true;
+    }
+    if (!visited.insert(std::make_pair(done, state)).second) {
+      return false;
+    }
+    // 下一个线性化的操作必须在所有未线性化操作中最早的返回之前被调用
+    std::uint64_t horizon = ~std::uint64_t(0);
+    for (std::size_t i = 0; i < ops.size(); i++) {
+      if (!(done & bit(i))) {
+        horizon = std::min(horizon, ops[i].returned);
+      }
+    }
+    for (std::size_t i = 0; i < ops.size(); i++) {
+      if ((done & bit(i)) || ops[i].invoked > horizon) {
+        continue;
+      }
+      std::vector<std::uint64_t> next = state;
+      if (Model::apply(ops[i], next) && search(done | bit(i), next)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static std::uint64_t bit(std::size_t i) {
+    return std::uint64_t(1) << i;
+  }
+
+  std::uint64_t all_done() const {
+    return ops.size() == 64 ? ~std::uint64_t(0)
+                            : (std::uint64_t(1) << ops.size()) - 1;
+  }
+};
+
+template <typename Model>
+bool check_linearizable(std::vector<operation> const &ops) {
+  return linearizability_checker<Model>(ops).check();
+}
+
+// rounds轮，每轮threads个线程各做ops_per_thread次随机push/try_pop
+template <template <typename> class Adapter>
+check_result linearize_stack(unsigned threads, unsigned ops_per_thread,
+                             unsigned rounds) {
+  assert(threads * ops_per_thread <= 64);
+  for (unsigned round = 0; round < rounds; round++) {
+    Adapter<std::uint64_t>   stack;
+    history                  log(threads);
+    start_gate               gate;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+      workers.push_back(std::thread([&, t] {
+        stress_random random(round * threads + t + 1);
+        gate.arrive_and_wait();
+        for (unsigned i = 0; i < ops_per_thread; i++) {
+          std::uint64_t const invoked = log.invoke();
+          if (random.next() % 2 == 0) {
+            std::uint64_t const value = stress_value(t, i);
+            stack.push(value);
+            log.complete(t, operation_push, value, true, invoked);
+          } else {
+            std::uint64_t value = 0;
+            bool const    ok    = stack.try_pop(value);
+            log.complete(t, operation_pop, value, ok, invoked);
+          }
+        }
+      }));
+    }
+    gate.open_when(threads);
+    for (std::size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+    if (!check_linearizable<stack_model>(log.operations())) {
+      std::ostringstream out;
+      out << "round " << round << " is not linearizable";
+      return check_result{false, out.str()};
+    }
+  }
+  std::ostringstream out;
+  out << rounds << " rounds";
+  return check_result{true, out.str()};
+}
+
+// 每轮producers个线程各push items个元素，consumers个线程合计pop同样多个
+template <template <typename> class Adapter>
+check_result linearize_queue(unsigned producers, unsigned consumers,
+                             unsigned items, unsigned rounds) {
+  unsigned const total = producers * items;
+  assert(total * 2 <= 64);
+  for (unsigned round = 0; round < rounds; round++) {
+    Adapter<std::uint64_t>   queue;
+    history                  log(producers + consumers);
+    start_gate               gate;
+    std::vector<std::thread> workers;
+    for (unsigned p = 0; p < producers; p++) {
+      workers.push_back(std::thread([&, p] {
+        gate.arrive_and_wait();
+        for (unsigned i = 0; i < items; i++) {
+          std::uint64_t const invoked = log.invoke();
+          std::uint64_t const value   = stress_value(p, i);
+          queue.push(value);
+          log.complete(p, operation_push, value, true, invoked);
+        }
+      }));
+    }
+    for (unsigned c = 0; c < consumers; c++) {
+      unsigned const share = total / consumers + (c < total % consumers);
+      workers.push_back(std::thread([&, c, share] {
+        gate.arrive_and_wait();
+        for (unsigned i = 0; i < share; i++) {
+          std::uint64_t const invoked = log.invoke();
+          std::uint64_t       value;
+          queue.pop(value);
+          log.complete(producers + c, operation_pop, value, true, invoked);
+        }
+      }));
+    }
+    gate.open_when(producers + consumers);
+    for (std::size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+    if (!check_linearizable<queue_model>(log.operations())) {
+      std::ostringstream out;
+      out << "round " << round << " is not linearizable";
+      return check_result{false, out.str()};
+    }
+  }
+  std::ostringstream out;
+  out << rounds << " rounds";
+  return check_result{true, out.str()};
+}
+
+// 适配器声明了relaxed_fifo时只做压力测试，不检查线性一致性
+template <typename Adapter>
+class is_relaxed_fifo {
+  template <typename U>
+  static char test(typename U::relaxed_fifo *);
+  template <typename U>
+  static long test(...);
+
+public:
+  static bool const value = sizeof(test<Adapter>(0)) == sizeof(char);
+};
+
+#endif  // !_STRESS_H_
@@ -0,0 +1,84 @@
+/**
+ * @file sharded_queue.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 分片队列与单一threadsafe_queue在多生产者下的吞吐对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "sharded_queue.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "join_threader.hpp"
+
+unsigned const items_per_producer = 100000;
+
+// 高32位为生产者编号，低32位为该生产者内的序号
+typedef std::uint64_t item_type;
+
+template <typename Queue>
+double run(Queue &queue, unsigned producers, unsigned consumers) {
+  std::atomic<unsigned long> remaining(
+      static_cast<unsigned long>(producers) * items_per_producer);
+  std::atomic<bool>        order_broken(false);
+  std::vector<std::thread> threads;
+  auto const               start = std::chrono::steady_clock::now();
+  {
+    join_threader joiner(threads);
+    for (unsigned p = 0; p < producers; p++) {
+      threads.push_back(std::thread([&queue, p] {
+        for (unsigned i = 0; i < items_per_producer; i++) {
+          queue.push((static_cast<item_type>(p) << 32) | i);
+        }
+      }));
+    }
+    for (unsigned c = 0; c < consumers; c++) {
+      threads.push_back(std::thread([&queue, &remaining, &order_broken,
+                                     producers] {
+        // 单个消费者看到的同一生产者序号必须递增
+        std::vector<long> last_seen(producers, -1);
+        item_type         item;
+        while (remaining.load(std::memory_order_relaxed) > 0) {
+          if (!queue.try_pop(item)) {
+            std::this_thread::yield();
+            continue;
+          }
+          remaining.fetch_sub(1, std::memory_order_relaxed);
+          unsigned const producer = static_cast<unsigned>(item >> 32);
+          long const     seq      = static_cast<long>(item & 0xffffffffu);
+          if (seq <= last_seen[producer]) {
+            order_broken = true;
+          }
+          last_seen[producer] = seq;
+        }
+      }));
+    }
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (order_broken) {
+    std::cout << "per-producer order broken" << std::endl;
+  }
+  return producers * items_per_producer / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+  unsigned const producers = argc > 1 ? std::atoi(argv[1]) : 32;
+  unsigned const consumers = argc > 2 ? std::atoi(argv[2]) : 4;
+
+  threadsafe_queue<item_type> single;
+  std::cout << "threadsafe_queue: " << run(single, producers, consumers)
+            << " ops/s" << std::endl;
+
+  sharded_queue<item_type> sharded;
+  std::cout << "sharded_queue(" << sharded.shard_count()
+            << "): " << run(sharded, producers, consumers) << " ops/s"
+            << std::endl;
+}
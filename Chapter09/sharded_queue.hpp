@@ -0,0 +1,169 @@
+/**
+ * @file sharded_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 分片的松弛FIFO队列，用于大量生产者汇聚的场景
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 顺序保证(relaxed FIFO)：
+ *  1. 每个线程固定映射到一个分片，同一生产者push的元素按push顺序出队；
+ *  2. 不同生产者之间的元素没有顺序保证；
+ *  3. try_pop返回false只表示扫描过程中每个分片都曾为空，并非线性化的"队列为空"。
+ */
+
+#ifndef _SHARDED_QUEUE_H_
+#define _SHARDED_QUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "threadsafe_queue.hpp"
+
+// 线程首次使用时领取一个序号，之后固定映射到同一分片
+inline unsigned this_thread_shard_seed() {
+  static std::atomic<unsigned> next_seed(0);
+  thread_local unsigned const  seed = next_seed.fetch_add(1);
+  return seed;
+}
+
+// 线程私有的xorshift随机数，用于两次随机选择
+inline std::uint32_t this_thread_random() {
+  thread_local std::uint32_t state = 2463534242u + this_thread_shard_seed();
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+template <typename T, typename Queue = threadsafe_queue<T>>
+class sharded_queue {
+public:
+  explicit sharded_queue(unsigned num_shards = std::thread::hardware_concurrency())
+      : waiters(0) {
+    if (num_shards == 0) {
+      num_shards = 1;
+    }
+    for (unsigned i = 0; i < num_shards; i++) {
+      shards.push_back(std::unique_ptr<shard>(new shard));
+    }
+  }
+
+  sharded_queue(const sharded_queue &) = delete;
+  sharded_queue &operator=(const sharded_queue &) = delete;
+
+  void push(T value) {
+    emplace(std::move(value));
+  }
+
+  template <typename... Args>
+  void emplace(Args &&...args) {
+    shard &s = *shards[this_thread_shard_seed() % shards.size()];
+    s.queue.emplace(std::forward<Args>(args)...);
+    s.size.fetch_add(1);
+    if (waiters.load() > 0) {
+      std::lock_guard<std::mutex> lk{wait_mutex};
+      wait_con.notify_one();
+    }
+  }
+
+  bool try_pop(T &value) {
+    return pop_any([&value](Queue &queue) {
+      return queue.try_pop(value);
+    });
+  }
+
+  // 出队成功才分配，不要求T可默认构造
+  std::shared_ptr<T> try_pop() {
+    std::shared_ptr<T> res;
+    pop_any([&res](Queue &queue) {
+      res = queue.try_pop();
+      return res != nullptr;
+    });
+    return res;
+  }
+
+  void wait_and_pop(T &value) {
+    while (!try_pop(value)) {
+      std::unique_lock<std::mutex> lk{wait_mutex};
+      waiters.fetch_add(1);
+      wait_con.wait(lk, [this] {
+        return !empty();
+      });
+      waiters.fetch_sub(1);
+    }
+  }
+
+  bool empty() const {
+    for (std::size_t i = 0; i < shards.size(); i++) {
+      if (shards[i]->size.load() > 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::size_t shard_count() const {
+    return shards.size();
+  }
+
+private:
+  struct shard {
+    Queue             queue;
+    std::atomic<long> size;  // 近似长度，出队可能先于计数，短暂为负
+    char              padding[64];  // 避免相邻分片计数之间的伪共享
+    shard() : size(0) {
+    }
+  };
+
+  std::vector<std::unique_ptr<shard>> shards;
+  std::atomic<unsigned>               waiters;
+  std::mutex                          wait_mutex;
+  std::condition_variable             wait_con;
+
+  template <typename Pop>
+  bool pop_any(Pop pop) {
+    std::size_t const n = shards.size();
+    if (n > 1) {
+      // power-of-two-choices：随机选两个分片，从较长的那个出队
+      std::size_t a = this_thread_random() % n;
+      std::size_t b = this_thread_random() % n;
+      if (shards[b]->size.load(std::memory_order_relaxed) >
+          shards[a]->size.load(std::memory_order_relaxed)) {
+        a = b;
+      }
+      if (pop_from(*shards[a], pop)) {
+        return true;
+      }
+    }
+    // 两次选择都落空时轮询全部分片
+    std::size_t const start = this_thread_random() % n;
+    for (std::size_t i = 0; i < n; i++) {
+      if (pop_from(*shards[(start + i) % n], pop)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename Pop>
+  static bool pop_from(shard &s, Pop &pop) {
+    if (s.size.load(std::memory_order_relaxed) <= 0) {
+      return false;
+    }
+    if (!pop(s.queue)) {
+      return false;
+    }
+    s.size.fetch_sub(1);
+    return true;
+  }
+};
+
+#endif  // !_SHARDED_QUEUE_H_
@@ -1,4 +1,4 @@
-#ifndef _THREDA_SAFE_QUEUE_H_
+#ifndef _THREAD_SAFE_QUEUE_H_
 #define _THREAD_SAFE_QUEUE_H_
 
 #include <condition_variable>
@@ -6,6 +6,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 
 template <typename T>
 class threadsafe_queue {
@@ -23,6 +24,12 @@ public:
   void               push(T value);
   bool               empty();
 
+  // 直接在共享节点里构造元素，省去push按值传参后的一次拷贝/移动
+  template <typename... Args>
+  void emplace(Args &&...args) {
+    push_data(std::make_shared<T>(std::forward<Args>(args)...));
+  }
+
 private:
   struct node {
     std::shared_ptr<T>    data;
@@ -73,6 +80,18 @@ private:
     return pop_head();
   }
 
+  void push_data(std::shared_ptr<T> new_data) {
+    std::unique_ptr<node> p(new node);
+    {
+      std::lock_guard<std::mutex> tail_lock{tail_mutex};
+      tail->data           = std::move(new_data);
+      node *const new_tail = p.get();
+      tail->next           = std::move(p);
+      tail                 = new_tail;
+    }
+    data_con.notify_one();
+  }
+
   std::unique_ptr<node> try_pop_head(T &value) {
     std::lock_guard<std::mutex> lk{head_mutex};
     if (head.get() == get_tail()) {
@@ -85,16 +104,7 @@ private:
 
 template <typename T>
 void threadsafe_queue<T>::push(T value) {
-  std::shared_ptr<T>    new_data = std::make_shared<T>(std::move(value));
-  std::unique_ptr<node> p(new node);
-  {
-    std::lock_guard<std::mutex> tail_lock{tail_mutex};
-    tail->data           = new_data;
-    node *const new_tail = p.get();
-    tail->next           = std::move(p);
-    tail                 = new_tail;
-  }
-  data_con.notify_one();
+  push_data(std::make_shared<T>(std::move(value)));
 }
 
 template <typename T>
@@ -117,7 +127,7 @@ std::shared_ptr<T> threadsafe_queue<T>::try_pop() {
 template <typename T>
 bool threadsafe_queue<T>::try_pop(T &value) {
   std::unique_ptr<node> old_head = try_pop_head(value);
-  return old_head == nullptr;
+  return old_head != nullptr;
 }
 
 template <typename T>
@@ -126,4 +136,4 @@ bool threadsafe_queue<T>::empty() {
   return head.get() == get_tail();
 }
 
-#endif  // !_THREDA_SAFE_QUEUE_H_
\ No newline at end of file
+#endif  // !_THREAD_SAFE_QUEUE_H_
\ No newline at end of file
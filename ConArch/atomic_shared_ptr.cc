@@ -0,0 +1,150 @@
+/**
+ * @file atomic_shared_ptr.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief atomic_shared_ptr与std::atomic_load/atomic_store的配置热切换对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 先用compare_exchange做并发计数检查正确性，
+ * 再让多个读者不断读取配置快照，一个写者每隔update_interval发布新配置，
+ * 比较两种实现的读吞吐。
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "atomic_shared_ptr.hpp"
+
+struct config {
+  std::uint64_t version;
+  std::uint64_t checksum;  // 总是version * 3
+
+  explicit config(std::uint64_t version_)
+      : version(version_), checksum(version_ * 3) {
+  }
+};
+
+class lock_free_config {
+public:
+  lock_free_config() : current(std::make_shared<config>(1)) {
+  }
+
+  std::shared_ptr<config> load() const {
+    return current.load();
+  }
+
+  void store(std::shared_ptr<config> next) {
+    current.store(std::move(next));
+  }
+
+private:
+  atomic_shared_ptr<config> current;
+};
+
+// libstdc++用全局自旋锁表实现
+class std_atomic_config {
+public:
+  std_atomic_config() : current(std::make_shared<config>(1)) {
+  }
+
+  std::shared_ptr<config> load() const {
+    return std::atomic_load(&current);
+  }
+
+  void store(std::shared_ptr<config> next) {
+    std::atomic_store(&current, std::move(next));
+  }
+
+private:
+  std::shared_ptr<config> current;
+};
+
+struct bench_result {
+  double reads_per_second;
+  bool   consistent;
+};
+
+template <typename Config>
+bench_result run_bench(unsigned readers, std::chrono::milliseconds duration) {
+  std::chrono::microseconds const update_interval(200);
+
+  Config                     snapshot;
+  std::atomic<bool>          stop(false);
+  std::atomic<std::uint64_t> reads(0);
+  std::atomic<bool>          consistent(true);
+  std::vector<std::thread>   threads;
+  for (unsigned t = 0; t < readers; t++) {
+    threads.push_back(std::thread([&snapshot, &stop, &reads, &consistent] {
+      std::uint64_t count = 0;
+      bool          ok    = true;
+      while (!stop.load(std::memory_order_relaxed)) {
+        std::shared_ptr<config> const current = snapshot.load();
+        ok = current->checksum == current->version * 3 && ok;
+        ++count;
+      }
+      reads += count;
+      if (!ok) {
+        consistent.store(false);
+      }
+    }));
+  }
+  auto const start = std::chrono::steady_clock::now();
+  for (std::uint64_t version = 2;
+       std::chrono::steady_clock::now() - start < duration; version++) {
+    snapshot.store(std::make_shared<config>(version));
+    std::this_thread::sleep_for(update_interval);
+  }
+  stop.store(true);
+  for (std::size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  bench_result result;
+  result.reads_per_second = reads.load() / elapsed.count();
+  result.consistent       = consistent.load();
+  return result;
+}
+
+int main(int argc, char **argv) {
+  // 每个线程用CAS循环把计数加一，最终值应等于总次数
+  atomic_shared_ptr<int>   counter(std::make_shared<int>(0));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.push_back(std::thread([&counter] {
+      for (int j = 0; j < 20000; j++) {
+        std::shared_ptr<int> expected = counter.load();
+        while (!counter.compare_exchange_weak(
+            expected, std::make_shared<int>(*expected + 1))) {
+        }
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  std::cout << "counter " << *counter.load()
+            << (*counter.load() == 80000 ? " ok" : " mismatch")
+            << ", lock free: " << std::boolalpha << counter.is_lock_free()
+            << std::endl;
+
+  std::chrono::milliseconds const duration(300);
+  std::printf("%-8s %18s %18s\n", "readers", "atomic_shared_ptr",
+              "std::atomic_load");
+  for (unsigned readers = 1; readers <= 8; readers *= 2) {
+    bench_result const split = run_bench<lock_free_config>(readers, duration);
+    bench_result const locked =
+        run_bench<std_atomic_config>(readers, duration);
+    std::printf("%-8u %18.0f %18.0f%s\n", readers, split.reads_per_second,
+                locked.reads_per_second,
+                split.consistent && locked.consistent ? "" : " inconsistent");
+  }
+}
@@ -0,0 +1,191 @@
+/**
+ * @file atomic_shared_ptr.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 双计数法实现的无锁atomic_shared_ptr
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * libstdc++的std::atomic_load/atomic_store(shared_ptr*)用全局的自旋锁表保护，
+ * 所有读者都要抢同一组锁。这里的做法与lock_free_stack的双计数相同：
+ * - 当前值放在一个holder里，holder持有一个std::shared_ptr<T>；
+ * - 原子量是一个64位字，低48位为holder指针，高16位为外部计数；
+ * - load先把外部计数加一"借用"holder，复制其中的shared_ptr，
+ *   再把外部计数减一归还；若holder在此期间已被替换，就改为把内部计数减一；
+ * - store/exchange/compare_exchange换下holder时把外部计数转移到内部计数上，
+ *   内部计数归零时删除holder。
+ * holder从不被重新装回，借用期间也不会被释放，因此指针比较不存在ABA。
+ * 同时借用同一holder的线程不能超过65535个。
+ */
+
+#ifndef _ATOMIC_SHARED_PTR_H_
+#define _ATOMIC_SHARED_PTR_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "node_pool.hpp"
+
+template <typename T>
+class atomic_shared_ptr {
+  static_assert(sizeof(void *) == 8,
+                "atomic_shared_ptr packs the count into a 64-bit word");
+
+  struct holder : pooled<holder> {
+    std::shared_ptr<T> const value;
+    std::atomic<int>         internal_count;
+
+    explicit holder(std::shared_ptr<T> value_)
+        : value(std::move(value_)), internal_count(0) {
+    }
+  };
+
+  static unsigned const      pointer_bits = 48;
+  static std::uint64_t const pointer_mask =
+      (std::uint64_t(1) << pointer_bits) - 1;
+  static std::uint64_t const one_count = std::uint64_t(1) << pointer_bits;
+
+public:
+  atomic_shared_ptr() : head(pack(new holder(std::shared_ptr<T>()))) {
+  }
+
+  explicit atomic_shared_ptr(std::shared_ptr<T> desired)
+      : head(pack(new holder(std::move(desired)))) {
+  }
+
+  atomic_shared_ptr(const atomic_shared_ptr &) = delete;
+  atomic_shared_ptr &operator=(const atomic_shared_ptr &) = delete;
+
+  ~atomic_shared_ptr() {
+    delete pointer_of(head.load(std::memory_order_acquire));
+  }
+
+  bool is_lock_free() const {
+    return head.is_lock_free();
+  }
+
+  std::shared_ptr<T> load() const {
+    holder *const      h = borrow();
+    std::shared_ptr<T> result(h->value);
+    give_back(h);
+    return result;
+  }
+
+  void store(std::shared_ptr<T> desired) {
+    exchange(std::move(desired));
+  }
+
+  std::shared_ptr<T> exchange(std::shared_ptr<T> desired) {
+    holder *const       replacement = new holder(std::move(desired));
+    std::uint64_t const old =
+        head.exchange(pack(replacement), std::memory_order_acq_rel);
+    holder *const      h = pointer_of(old);
+    std::shared_ptr<T> result(h->value);
+    retire(h, count_of(old));
+    return result;
+  }
+
+  // 当前值与expected指向同一对象且共享所有权时替换为desired，
+  // 否则把当前值写回expected
+  bool compare_exchange_strong(std::shared_ptr<T> &expected,
+                               std::shared_ptr<T>  desired) {
+    holder *replacement = nullptr;
+    for (;;) {
+      std::uint64_t current = borrow_packed();
+      holder *const h       = pointer_of(current);
+      if (!equivalent(h->value, expected)) {
+        expected = h->value;
+        give_back(h);
+        delete replacement;
+        return false;
+      }
+      if (!replacement) {
+        replacement = new holder(std::move(desired));
+      }
+      while (pointer_of(current) == h) {
+        if (head.compare_exchange_weak(current, pack(replacement),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+          // 自己的借用随替换一起结束，不再转移
+          retire(h, count_of(current) - 1);
+          return true;
+        }
+      }
+      give_back(h);
+    }
+  }
+
+  bool compare_exchange_weak(std::shared_ptr<T> &expected,
+                             std::shared_ptr<T>  desired) {
+    return compare_exchange_strong(expected, std::move(desired));
+  }
+
+private:
+  mutable std::atomic<std::uint64_t> head;
+
+  static holder *pointer_of(std::uint64_t packed) {
+    return reinterpret_cast<holder *>(
+        static_cast<std::uintptr_t>(packed & pointer_mask));
+  }
+
+  static unsigned count_of(std::uint64_t packed) {
+    return static_cast<unsigned>(packed >> pointer_bits);
+  }
+
+  static std::uint64_t pack(holder *h) {
+    std::uint64_t const bits = reinterpret_cast<std::uintptr_t>(h);
+    assert((bits & ~pointer_mask) == 0);
+    return bits;
+  }
+
+  static bool equivalent(std::shared_ptr<T> const &a,
+                         std::shared_ptr<T> const &b) {
+    return a.get() == b.get() && !a.owner_before(b) && !b.owner_before(a);
+  }
+
+  // 把外部计数加一，返回加一之后的值
+  std::uint64_t borrow_packed() const {
+    std::uint64_t old = head.load(std::memory_order_relaxed);
+    std::uint64_t next;
+    do {
+      assert(count_of(old) < (1u << (64 - pointer_bits)) - 1);
+      next = old + one_count;
+    } while (!head.compare_exchange_weak(old, next, std::memory_order_acquire,
+                                         std::memory_order_relaxed));
+    return next;
+  }
+
+  holder *borrow() const {
+    return pointer_of(borrow_packed());
+  }
+
+  void give_back(holder *h) const {
+    std::uint64_t old = head.load(std::memory_order_relaxed);
+    while (pointer_of(old) == h) {
+      if (head.compare_exchange_weak(old, old - one_count,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    // holder已被换下，借用计数已转移到内部计数上
+    if (h->internal_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete h;
+    }
+  }
+
+  // 换下的holder还有borrowed个借用者未归还
+  static void retire(holder *h, unsigned borrowed) {
+    int const count = static_cast<int>(borrowed);
+    if (h->internal_count.fetch_add(count, std::memory_order_acq_rel) ==
+        -count) {
+      delete h;
+    }
+  }
+};
+
+#endif  // !_ATOMIC_SHARED_PTR_H_
@@ -0,0 +1,126 @@
+/**
+ * @file bounded_ring_queue.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 大消息在有界环形队列中的拷贝传递与原地读写对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "bounded_ring_queue.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+struct message {
+  std::uint64_t seq;
+  char          body[16 * 1024 - sizeof(std::uint64_t)];
+};
+
+std::uint64_t const message_count = 200000;
+
+// 生产者在栈上构造消息后push拷贝进队列，消费者try_pop再拷贝出来
+double run_copy() {
+  bounded_ring_queue<message> queue(256);
+  auto const                  start = std::chrono::steady_clock::now();
+  std::thread                 producer{[&queue] {
+    message m;
+    std::memset(m.body, 'x', sizeof(m.body));
+    for (std::uint64_t i = 0; i < message_count; i++) {
+      m.seq = i;
+      queue.push(m);
+    }
+  }};
+  std::uint64_t sum = 0;
+  message       m;
+  for (std::uint64_t i = 0; i < message_count; i++) {
+    queue.wait_and_pop(m);
+    sum += m.seq + m.body[i % sizeof(m.body)];
+  }
+  producer.join();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "copy checksum " << sum << std::endl;
+  return message_count / elapsed.count();
+}
+
+// 生产者直接写队列存储，消费者直接读队列存储
+double run_in_place() {
+  typedef bounded_ring_queue<message> queue_type;
+  queue_type                          queue(256);
+  auto const                          start = std::chrono::steady_clock::now();
+  std::thread                         producer{[&queue] {
+    for (std::uint64_t i = 0; i < message_count; i++) {
+      queue_type::write_slot slot;
+      while (!queue.try_reserve(slot)) {
+        std::this_thread::yield();
+      }
+      slot->seq = i;
+      std::memset(slot->body, 'x', sizeof(slot->body));
+      queue.commit(slot);
+    }
+  }};
+  std::uint64_t sum = 0;
+  for (std::uint64_t i = 0; i < message_count; i++) {
+    queue_type::read_slot slot;
+    while (!queue.try_peek(slot)) {
+      std::this_thread::yield();
+    }
+    sum += slot->seq + slot->body[i % sizeof(slot->body)];
+    queue.release(slot);
+  }
+  producer.join();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "in-place checksum " << sum << std::endl;
+  return message_count / elapsed.count();
+}
+
+// 每隔几个就在构造时抛异常的元素
+struct fragile {
+  std::uint64_t value;
+  explicit fragile(std::uint64_t value_) : value(value_) {
+    if (value % 3 == 0) {
+      throw std::runtime_error("fragile");
+    }
+  }
+};
+
+// 构造失败的槽位被跳过，绕多圈后其余元素仍按顺序出队
+bool check_throwing_constructor() {
+  bounded_ring_queue<fragile> queue(4);
+  std::uint64_t               next = 1;
+  bool                        ok   = true;
+  for (std::uint64_t i = 0; i < 100; i++) {
+    try {
+      queue.emplace(i);
+      ok = i % 3 != 0 && ok;
+    } catch (std::runtime_error const &) {
+      ok = i % 3 == 0 && ok;
+    }
+    if (i % 2 == 1) {
+      fragile popped(1);
+      while (queue.try_pop(popped)) {
+        ok = popped.value == next && ok;
+        next += next % 3 == 2 ? 2 : 1;
+      }
+    }
+  }
+  std::cout << "throwing constructor: " << (ok && next == 100 ? "ok" : "failed")
+            << std::endl;
+  return ok && next == 100;
+}
+
+int main(int argc, char **argv) {
+  if (!check_throwing_constructor()) {
+    return 1;
+  }
+  std::cout << "copy: " << run_copy() << " msgs/s" << std::endl;
+  std::cout << "in-place: " << run_in_place() << " msgs/s" << std::endl;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file bounded_ring_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 有界多生产者多消费者环形队列，支持原地构造和两阶段零拷贝读写
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 每个槽位带一个序号(Vyukov有界队列)：
+ *   sequence == pos              槽位空闲，可由写入pos的生产者认领
+ *   sequence == pos + 1          数据已提交，可由读取pos的消费者认领
+ *   sequence == pos + capacity   消费者已释放，留给下一圈的生产者
+ * 认领与提交/释放分离，于是大消息可以直接在队列存储里写入和读取：
+ *
+ *   write_slot w;                     read_slot r;
+ *   if (q.try_reserve(w)) {           if (q.try_peek(r)) {
+ *     w->field = ...;                   use(*r);
+ *     q.commit(w);                      q.release(r);
+ *   }                                 }
+ *
+ * 认领后必须尽快commit/release，否则后面一圈的同一槽位会一直等待。
+ * T的构造函数抛出异常时，已认领的槽位以"跳过"标记提交后再把异常抛给调用者，
+ * 消费者认领到这样的槽位时直接释放并继续取下一个，队列不会卡住。
+ */
+
+#ifndef _BOUNDED_RING_QUEUE_H_
+#define _BOUNDED_RING_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+template <typename T>
+class bounded_ring_queue {
+  struct cell;
+
+public:
+  // 生产者持有的已认领槽位，其中的T已构造，可原地修改
+  class write_slot {
+  public:
+    write_slot() : c(nullptr), pos(0) {
+    }
+    T *get() const {
+      return reinterpret_cast<T *>(&c->storage);
+    }
+    T &operator*() const {
+      return *get();
+    }
+    T *operator->() const {
+      return get();
+    }
+
+  private:
+    friend class bounded_ring_queue;
+    cell       *c;
+    std::size_t pos;
+  };
+
+  // 消费者持有的已认领槽位，release之前数据一直留在队列存储中
+  class read_slot {
+  public:
+    read_slot() : c(nullptr), pos(0) {
+    }
+    T *get() const {
+      return reinterpret_cast<T *>(&c->storage);
+    }
+    T &operator*() const {
+      return *get();
+    }
+    T *operator->() const {
+      return get();
+    }
+
+  private:
+    friend class bounded_ring_queue;
+    cell       *c;
+    std::size_t pos;
+  };
+
+  explicit bounded_ring_queue(std::size_t capacity_)
+      : capacity(capacity_), mask(capacity_ - 1), cells(new cell[capacity_]),
+        enqueue_pos(0), dequeue_pos(0) {
+    if (capacity == 0 || (capacity & mask) != 0) {
+      throw std::invalid_argument(
+          "bounded_ring_queue capacity must be a power of 2");
+    }
+    for (std::size_t i = 0; i < capacity; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bounded_ring_queue(const bounded_ring_queue &) = delete;
+  bounded_ring_queue &operator=(const bounded_ring_queue &) = delete;
+
+  ~bounded_ring_queue() {
+    read_slot slot;
+    while (try_peek(slot)) {
+      release(slot);
+    }
+  }
+
+  // 认领一个空闲槽位并默认初始化T(平凡类型不清零)，队列满时返回false
+  bool try_reserve(write_slot &slot) {
+    if (!claim_for_write(slot)) {
+      return false;
+    }
+    try {
+      new (&slot.c->storage) T;
+    } catch (...) {
+      abandon(slot);
+      throw;
+    }
+    return true;
+  }
+
+  // 认领一个空闲槽位并用args原地构造T
+  template <typename... Args>
+  bool try_reserve_emplace(write_slot &slot, Args &&...args) {
+    if (!claim_for_write(slot)) {
+      return false;
+    }
+    try {
+      new (&slot.c->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      abandon(slot);
+      throw;
+    }
+    return true;
+  }
+
+  void commit(write_slot &slot) {
+    slot.c->sequence.store(slot.pos + 1, std::memory_order_release);
+    slot.c = nullptr;
+  }
+
+  // 认领最早提交的槽位，队列空时返回false。构造失败的槽位直接释放
+  bool try_peek(read_slot &slot) {
+    std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell &            c   = cells[pos & mask];
+      std::size_t const seq = c.sequence.load(std::memory_order_acquire);
+      std::ptrdiff_t const diff = static_cast<std::ptrdiff_t>(seq) -
+                                  static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          if (c.skipped) {
+            c.sequence.store(pos + capacity, std::memory_order_release);
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+            continue;
+          }
+          slot.c   = &c;
+          slot.pos = pos;
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // 析构槽位中的T并把槽位交还给下一圈的生产者
+  void release(read_slot &slot) {
+    slot.get()->~T();
+    slot.c->sequence.store(slot.pos + capacity, std::memory_order_release);
+    slot.c = nullptr;
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args &&...args) {
+    write_slot slot;
+    if (!try_reserve_emplace(slot, std::forward<Args>(args)...)) {
+      return false;
+    }
+    commit(slot);
+    return true;
+  }
+
+  // 队列满时让出CPU直到有空位
+  template <typename... Args>
+  void emplace(Args &&...args) {
+    write_slot slot;
+    while (!claim_for_write(slot)) {
+      std::this_thread::yield();
+    }
+    try {
+      new (&slot.c->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      abandon(slot);
+      throw;
+    }
+    commit(slot);
+  }
+
+  bool try_push(T const &value) {
+    return try_emplace(value);
+  }
+
+  void push(T const &value) {
+    emplace(value);
+  }
+
+  bool try_pop(T &value) {
+    read_slot slot;
+    if (!try_peek(slot)) {
+      return false;
+    }
+    value = std::move(*slot);
+    release(slot);
+    return true;
+  }
+
+  void wait_and_pop(T &value) {
+    while (!try_pop(value)) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::size_t size() const {
+    return capacity;
+  }
+
+private:
+  // skipped由认领者写入，随sequence的提交一起发布
+  struct cell {
+    std::atomic<std::size_t>                                   sequence;
+    bool                                                       skipped;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  std::size_t const        capacity;
+  std::size_t const        mask;
+  std::unique_ptr<cell[]>  cells;
+  char                     padding0[64];  // 生产者与消费者下标各占一条缓存行
+  std::atomic<std::size_t> enqueue_pos;
+  char                     padding1[64];
+  std::atomic<std::size_t> dequeue_pos;
+  char                     padding2[64];
+
+  // 构造T失败：不含数据地提交，让消费者跳过
+  void abandon(write_slot &slot) {
+    slot.c->skipped = true;
+    commit(slot);
+  }
+
+  bool claim_for_write(write_slot &slot) {
+    std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell &            c   = cells[pos & mask];
+      std::size_t const seq = c.sequence.load(std::memory_order_acquire);
+      std::ptrdiff_t const diff = static_cast<std::ptrdiff_t>(seq) -
+                                  static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          c.skipped = false;
+          slot.c    = &c;
+          slot.pos  = pos;
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+};
+
+#endif  // !_BOUNDED_RING_QUEUE_H_
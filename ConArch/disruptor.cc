@@ -0,0 +1,103 @@
+/**
+ * @file disruptor.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 环形缓冲多播示例：日志、统计并行消费，处理阶段依赖两者(菱形依赖)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "disruptor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+struct event {
+  std::int64_t value;
+  std::int64_t doubled;  // 由metrics阶段写入，process阶段读取
+};
+
+std::int64_t const event_count = 10000000;
+std::size_t const  batch_size  = 64;
+
+template <typename WaitStrategy>
+void run(char const *name) {
+  typedef ring_buffer<event, WaitStrategy> ring_type;
+  ring_type                                ring(1024);
+
+  std::int64_t logged = 0, measured = 0, processed = 0;
+  auto         log_handler = [&logged](event const &e, std::int64_t, bool) {
+    logged += e.value;
+  };
+  // 只有metrics写doubled字段，process通过依赖屏障保证看到写入结果
+  auto metrics_handler = [&measured, &ring](event const &e, std::int64_t seq,
+                                            bool) {
+    measured += e.value;
+    ring[seq].doubled = e.value * 2;
+  };
+  auto process_handler = [&processed](event const &e, std::int64_t, bool) {
+    processed += e.doubled;
+  };
+
+  typedef typename ring_type::barrier_type barrier_type;
+  barrier_type *const first_barrier = ring.new_barrier();
+  batch_event_processor<event, WaitStrategy, decltype(log_handler)> logger(
+      ring, *first_barrier, log_handler);
+  batch_event_processor<event, WaitStrategy, decltype(metrics_handler)> metrics(
+      ring, *first_barrier, metrics_handler);
+  barrier_type *const second_barrier =
+      ring.new_barrier({&logger.get_sequence(), &metrics.get_sequence()});
+  batch_event_processor<event, WaitStrategy, decltype(process_handler)> process(
+      ring, *second_barrier, process_handler);
+  ring.add_gating_sequence(process.get_sequence());
+
+  auto const  start = std::chrono::steady_clock::now();
+  std::thread t1{[&logger] {
+    logger.run();
+  }};
+  std::thread t2{[&metrics] {
+    metrics.run();
+  }};
+  std::thread t3{[&process] {
+    process.run();
+  }};
+
+  for (std::int64_t published = 0; published < event_count;) {
+    std::size_t const n = static_cast<std::size_t>(
+        std::min<std::int64_t>(batch_size, event_count - published));
+    std::int64_t const hi = ring.next(n);
+    published += n;
+    for (std::int64_t seq = hi - n + 1; seq <= hi; seq++) {
+      ring[seq].value = seq;
+    }
+    ring.publish(hi);
+  }
+  while (process.get_sequence().get() < ring.get_cursor()) {
+    std::this_thread::yield();
+  }
+  first_barrier->alert();
+  second_barrier->alert();
+  t1.join();
+  t2.join();
+  t3.join();
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::int64_t const expected = event_count * (event_count - 1) / 2;
+  std::cout << name << ": " << event_count / elapsed.count() << " events/s "
+            << (logged == expected && measured == expected &&
+                        processed == 2 * expected
+                    ? "ok"
+                    : "mismatch")
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  run<yielding_wait_strategy>("yielding");
+  run<blocking_wait_strategy>("blocking");
+}
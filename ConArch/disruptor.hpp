@@ -0,0 +1,301 @@
+/**
+ * @file disruptor.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief Disruptor风格的单写多读环形缓冲：一次发布，多个消费者零拷贝读取
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 生产者通过next(n)批量申请槽位，直接在槽位上构造数据，再publish发布；
+ * - 每个消费者持有自己的sequence游标，通过sequence_barrier等待
+ *   生产者游标以及所依赖的上游消费者游标，从而形成依赖图(例如菱形)；
+ * - 处于依赖图末端的消费者游标作为gating sequence，防止生产者覆盖未读数据；
+ * - 等待策略作为模板参数：busy_spin / yielding / blocking。
+ */
+
+#ifndef _DISRUPTOR_H_
+#define _DISRUPTOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// 独占缓存行的序号，初始值为-1表示尚未处理任何槽位
+class sequence {
+public:
+  explicit sequence(std::int64_t initial = -1) : value(initial) {
+  }
+
+  std::int64_t get() const {
+    return value.load(std::memory_order_acquire);
+  }
+
+  void set(std::int64_t v) {
+    value.store(v, std::memory_order_release);
+  }
+
+private:
+  char                      padding_before[64];
+  std::atomic<std::int64_t> value;
+  char                      padding_after[64];
+};
+
+inline std::int64_t min_sequence(std::vector<sequence const *> const &sequences,
+                                 std::int64_t minimum) {
+  for (std::size_t i = 0; i < sequences.size(); i++) {
+    minimum = std::min(minimum, sequences[i]->get());
+  }
+  return minimum;
+}
+
+// 可用序号：生产者游标与所有上游消费者游标中的最小值
+inline std::int64_t available_sequence(
+    sequence const &cursor, std::vector<sequence const *> const &dependents) {
+  return min_sequence(dependents, cursor.get());
+}
+
+// 忙等，延迟最低，独占一个核
+struct busy_spin_wait_strategy {
+  std::int64_t wait_for(std::int64_t                         seq,
+                        sequence const &                     cursor,
+                        std::vector<sequence const *> const &dependents,
+                        std::atomic<bool> const &            alerted) {
+    std::int64_t available;
+    while ((available = available_sequence(cursor, dependents)) < seq) {
+      if (alerted.load()) {
+        return available;
+      }
+    }
+    return available;
+  }
+
+  void signal_all() {
+  }
+};
+
+// 自旋若干次后让出CPU
+struct yielding_wait_strategy {
+  std::int64_t wait_for(std::int64_t                         seq,
+                        sequence const &                     cursor,
+                        std::vector<sequence const *> const &dependents,
+                        std::atomic<bool> const &            alerted) {
+    unsigned     spins = 100;
+    std::int64_t available;
+    while ((available = available_sequence(cursor, dependents)) < seq) {
+      if (alerted.load()) {
+        return available;
+      }
+      if (spins > 0) {
+        --spins;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    return available;
+  }
+
+  void signal_all() {
+  }
+};
+
+// 在条件变量上等待生产者游标，适合消费者经常空闲、CPU紧张的场景；
+// 上游消费者的游标不会通知，仍以让出CPU的方式等待
+struct blocking_wait_strategy {
+  std::int64_t wait_for(std::int64_t                         seq,
+                        sequence const &                     cursor,
+                        std::vector<sequence const *> const &dependents,
+                        std::atomic<bool> const &            alerted) {
+    if (cursor.get() < seq) {
+      std::unique_lock<std::mutex> lk{mutex};
+      while (cursor.get() < seq) {
+        if (alerted.load()) {
+          return cursor.get();
+        }
+        con.wait(lk);
+      }
+    }
+    std::int64_t available;
+    while ((available = available_sequence(cursor, dependents)) < seq) {
+      if (alerted.load()) {
+        return available;
+      }
+      std::this_thread::yield();
+    }
+    return available;
+  }
+
+  void signal_all() {
+    std::lock_guard<std::mutex> lk{mutex};
+    con.notify_all();
+  }
+
+private:
+  std::mutex              mutex;
+  std::condition_variable con;
+};
+
+template <typename WaitStrategy>
+class sequence_barrier {
+public:
+  sequence_barrier(WaitStrategy &                       strategy_,
+                   sequence const &                     cursor_,
+                   std::vector<sequence const *> const &dependents_)
+      : strategy(strategy_), cursor(cursor_), dependents(dependents_),
+        alerted(false) {
+  }
+
+  // 返回不小于seq的最大可读序号；被alert唤醒时返回值小于seq
+  std::int64_t wait_for(std::int64_t seq) {
+    return strategy.wait_for(seq, cursor, dependents, alerted);
+  }
+
+  void alert() {
+    alerted = true;
+    strategy.signal_all();
+  }
+
+  bool is_alerted() const {
+    return alerted.load();
+  }
+
+private:
+  WaitStrategy &                strategy;
+  sequence const &              cursor;
+  std::vector<sequence const *> dependents;
+  std::atomic<bool>             alerted;
+};
+
+template <typename T, typename WaitStrategy = yielding_wait_strategy>
+class ring_buffer {
+public:
+  typedef sequence_barrier<WaitStrategy> barrier_type;
+
+  // 容量必须是2的幂，槽位在构造时一次性分配，之后复用
+  explicit ring_buffer(std::size_t capacity_)
+      : capacity(capacity_), mask(capacity_ - 1), entries(capacity_),
+        next_value(-1), cached_gating(-1) {
+    if (capacity == 0 || (capacity & mask) != 0) {
+      throw std::invalid_argument("ring_buffer capacity must be a power of 2");
+    }
+  }
+
+  ring_buffer(const ring_buffer &) = delete;
+  ring_buffer &operator=(const ring_buffer &) = delete;
+
+  // 生产者必须等待这些序号，避免覆盖尚未被读取的槽位
+  void add_gating_sequence(sequence const &seq) {
+    gating.push_back(&seq);
+  }
+
+  barrier_type *new_barrier(
+      std::vector<sequence const *> const &dependents =
+          std::vector<sequence const *>()) {
+    barriers.push_back(std::unique_ptr<barrier_type>(
+        new barrier_type(strategy, cursor, dependents)));
+    return barriers.back().get();
+  }
+
+  // 申请n个连续槽位，返回其中最大的序号；只允许单个生产者线程调用
+  std::int64_t next(std::size_t n = 1) {
+    if (n == 0 || n > capacity) {
+      throw std::invalid_argument("ring_buffer::next out of range");
+    }
+    std::int64_t const next_sequence =
+        next_value + static_cast<std::int64_t>(n);
+    std::int64_t const wrap_point =
+        next_sequence - static_cast<std::int64_t>(capacity);
+    if (wrap_point > cached_gating) {
+      std::int64_t minimum;
+      while (wrap_point > (minimum = min_sequence(gating, next_value))) {
+        std::this_thread::yield();
+      }
+      cached_gating = minimum;
+    }
+    next_value = next_sequence;
+    return next_sequence;
+  }
+
+  T &operator[](std::int64_t seq) {
+    return entries[static_cast<std::size_t>(seq) & mask];
+  }
+
+  T const &operator[](std::int64_t seq) const {
+    return entries[static_cast<std::size_t>(seq) & mask];
+  }
+
+  // 发布到hi为止的全部槽位(含批量申请的整段)
+  void publish(std::int64_t hi) {
+    cursor.set(hi);
+    strategy.signal_all();
+  }
+
+  std::int64_t get_cursor() const {
+    return cursor.get();
+  }
+
+  std::size_t size() const {
+    return capacity;
+  }
+
+private:
+  std::size_t const                          capacity;
+  std::size_t const                          mask;
+  std::vector<T>                             entries;
+  sequence                                   cursor;
+  WaitStrategy                               strategy;
+  std::vector<sequence const *>              gating;
+  std::vector<std::unique_ptr<barrier_type>> barriers;
+  std::int64_t                               next_value;     // 仅生产者访问
+  std::int64_t                               cached_gating;  // 仅生产者访问
+};
+
+// 消费者线程主循环：每次取到一批可读槽位后依次交给handler，
+// handler签名为void(T const &event, std::int64_t seq, bool end_of_batch)
+template <typename T, typename WaitStrategy, typename Handler>
+class batch_event_processor {
+public:
+  batch_event_processor(ring_buffer<T, WaitStrategy> &  ring_,
+                        sequence_barrier<WaitStrategy> &barrier_,
+                        Handler                         handler_)
+      : ring(ring_), barrier(barrier_), handler(handler_) {
+  }
+
+  sequence const &get_sequence() const {
+    return seq;
+  }
+
+  void run() {
+    std::int64_t next = seq.get() + 1;
+    for (;;) {
+      std::int64_t const available = barrier.wait_for(next);
+      if (available < next) {
+        break;  // 被halt唤醒
+      }
+      for (; next <= available; next++) {
+        handler(static_cast<ring_buffer<T, WaitStrategy> const &>(ring)[next],
+                next, next == available);
+      }
+      seq.set(available);
+    }
+  }
+
+  // 不保证处理完剩余数据：调用方应等get_sequence()追上生产者游标后再调用
+  void halt() {
+    barrier.alert();
+  }
+
+private:
+  ring_buffer<T, WaitStrategy> &  ring;
+  sequence_barrier<WaitStrategy> &barrier;
+  Handler                         handler;
+  sequence                        seq;
+};
+
+#endif  // !_DISRUPTOR_H_
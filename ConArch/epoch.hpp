@@ -0,0 +1,234 @@
+/**
+ * @file epoch.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 基于纪元的内存回收(EBR)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 线程通过epoch_guard进入临界区，进入时把全局纪元记录到自己的线程记录上，
+ *   临界区内访问的节点在离开前都不会被释放，遍历时不需要逐个发布指针；
+ * - retire把节点放进本线程按"纪元 % 3"划分的三个待回收(limbo)列表之一；
+ * - 每retire若干次尝试推进全局纪元：只要所有处于临界区的线程都已观察到当前纪元，
+ *   就可以加一。纪元为e时，纪元不大于e - 2时退休的节点已无人引用，可以释放。
+ * 代价是一个长时间停留在临界区的线程会阻止所有回收。
+ * 线程记录的认领与归还方式与hazard_pointer_domain相同，域必须比使用它的线程活得更久。
+ */
+
+#ifndef _EPOCH_H_
+#define _EPOCH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class epoch_domain {
+  struct retired_node {
+    void *pointer;
+    void (*deleter)(void *);
+  };
+
+  struct limbo_list {
+    std::uint64_t             epoch;
+    std::vector<retired_node> nodes;
+    limbo_list() : epoch(0) {
+    }
+  };
+
+public:
+  // 每retire这么多次尝试推进一次纪元
+  static unsigned const advance_interval = 64;
+
+  struct thread_record {
+    std::atomic<std::uint64_t> epoch;  // 0表示不在临界区，否则为(纪元 << 1) | 1
+    unsigned                   nesting;  // 以下成员仅由持有记录的线程访问
+    unsigned                   retire_count;
+    limbo_list                 limbo[3];
+    std::atomic<bool>          active;
+    thread_record             *next;  // 发布到链表后不再修改
+
+    thread_record()
+        : epoch(0), nesting(0), retire_count(0), active(true), next(nullptr) {
+    }
+  };
+
+  epoch_domain() : global_epoch(1), records(nullptr) {
+  }
+
+  epoch_domain(const epoch_domain &) = delete;
+  epoch_domain &operator=(const epoch_domain &) = delete;
+
+  ~epoch_domain() {
+    thread_record *current = records.load();
+    while (current) {
+      thread_record *const next = current->next;
+      for (unsigned i = 0; i < 3; i++) {
+        free_nodes(current->limbo[i].nodes);
+      }
+      delete current;
+      current = next;
+    }
+  }
+
+  void enter(thread_record &record) {
+    if (record.nesting++ == 0) {
+      // 单独的seq_cst写入挡不住之后的acquire读被重排到它前面(store->load)，
+      // 这里的栅栏与try_advance开头的栅栏配对：要么推进者看到本线程的纪元，
+      // 要么本线程之后的读取看到节点已被摘除
+      record.epoch.store((global_epoch.load() << 1) | 1,
+                         std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  void leave(thread_record &record) {
+    if (--record.nesting == 0) {
+      record.epoch.store(0, std::memory_order_release);
+    }
+  }
+
+  template <typename T>
+  void retire(T *p) {
+    retire(p, &do_delete<T>);
+  }
+
+  void retire(void *p, void (*deleter)(void *)) {
+    thread_record      &record = this_thread_record();
+    std::uint64_t const epoch  = global_epoch.load();
+    limbo_list         &limbo  = record.limbo[epoch % 3];
+    if (limbo.epoch != epoch) {
+      // 同一下标上次使用时的纪元不大于epoch - 3，其中的节点已可释放
+      free_nodes(limbo.nodes);
+      limbo.epoch = epoch;
+    }
+    limbo.nodes.push_back(retired_node{p, deleter});
+    if (++record.retire_count % advance_interval == 0) {
+      try_advance();
+      collect(record);
+    }
+  }
+
+  thread_record &this_thread_record() {
+    thread_records &owned = owned_records();
+    for (std::size_t i = 0; i < owned.entries.size(); i++) {
+      if (owned.entries[i].first == this) {
+        return *owned.entries[i].second;
+      }
+    }
+    thread_record *const record = acquire_record();
+    owned.entries.push_back(std::make_pair(this, record));
+    return *record;
+  }
+
+private:
+  struct thread_records {
+    std::vector<std::pair<epoch_domain *, thread_record *>> entries;
+
+    ~thread_records() {
+      for (std::size_t i = 0; i < entries.size(); i++) {
+        entries[i].first->release_record(entries[i].second);
+      }
+    }
+  };
+
+  std::atomic<std::uint64_t>   global_epoch;
+  std::atomic<thread_record *> records;
+
+  template <typename T>
+  static void do_delete(void *p) {
+    delete static_cast<T *>(p);
+  }
+
+  static thread_records &owned_records() {
+    thread_local thread_records owned;
+    return owned;
+  }
+
+  static void free_nodes(std::vector<retired_node> &nodes) {
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+      nodes[i].deleter(nodes[i].pointer);
+    }
+    nodes.clear();
+  }
+
+  // 所有处于临界区的线程都已进入当前纪元时，把全局纪元加一
+  void try_advance() {
+    // 与enter中的栅栏配对，之前摘除节点的写入先于下面对各线程纪元的读取
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::uint64_t const epoch = global_epoch.load();
+    for (thread_record *current = records.load(); current;
+         current = current->next) {
+      std::uint64_t const local = current->epoch.load();
+      if ((local & 1) && (local >> 1) != epoch) {
+        return;
+      }
+    }
+    std::uint64_t expected = epoch;
+    global_epoch.compare_exchange_strong(expected, epoch + 1);
+  }
+
+  // 释放本线程中纪元不大于全局纪元-2的limbo列表
+  void collect(thread_record &record) {
+    std::uint64_t const epoch = global_epoch.load();
+    for (unsigned i = 0; i < 3; i++) {
+      limbo_list &limbo = record.limbo[i];
+      if (!limbo.nodes.empty() && limbo.epoch + 2 <= epoch) {
+        free_nodes(limbo.nodes);
+      }
+    }
+  }
+
+  thread_record *acquire_record() {
+    for (thread_record *current = records.load(); current;
+         current = current->next) {
+      bool expected = false;
+      if (!current->active.load() &&
+          current->active.compare_exchange_strong(expected, true)) {
+        return current;
+      }
+    }
+    thread_record *const record = new thread_record;
+    record->next                = records.load();
+    while (!records.compare_exchange_weak(record->next, record)) {
+    }
+    return record;
+  }
+
+  void release_record(thread_record *record) {
+    record->nesting = 0;
+    record->epoch.store(0);
+    try_advance();
+    collect(*record);  // 剩余节点留给下一个认领该记录的线程
+    record->active.store(false);
+  }
+};
+
+inline epoch_domain &default_epoch_domain() {
+  static epoch_domain domain;
+  return domain;
+}
+
+// 临界区守卫：构造时进入，析构时离开，可以嵌套
+class epoch_guard {
+public:
+  explicit epoch_guard(epoch_domain &domain_ = default_epoch_domain())
+      : domain(domain_), record(domain_.this_thread_record()) {
+    domain.enter(record);
+  }
+
+  epoch_guard(epoch_guard const &) = delete;
+  epoch_guard &operator=(epoch_guard const &) = delete;
+
+  ~epoch_guard() {
+    domain.leave(record);
+  }
+
+private:
+  epoch_domain                &domain;
+  epoch_domain::thread_record &record;
+};
+
+#endif  // !_EPOCH_H_
@@ -0,0 +1,239 @@
+/**
+ * @file hazard_pointer.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 可复用的风险指针域：动态注册线程记录、每线程多个风险指针、批量回收
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 线程第一次使用某个域时从记录链表中认领(或新建)一条线程记录，
+ *   线程退出时归还，记录本身永不释放，供后来的线程复用；
+ * - 每条记录有slots_per_thread个风险指针槽位，由hazard_pointer按RAII占用；
+ * - retire把节点放进本线程的待回收列表，列表长度超过
+ *   max(2 * 全部槽位数, 64)时做一次扫描：把所有活跃风险指针快照成有序数组，
+ *   再逐个二分查找待回收节点。每次扫描至少释放一半节点，均摊每个节点O(1)。
+ * 域对象必须比所有使用它的线程活得更久，一般直接使用default_hazard_domain()。
+ */
+
+#ifndef _HAZARD_POINTER_H_
+#define _HAZARD_POINTER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+class hazard_pointer_domain {
+  struct retired_node {
+    void *pointer;
+    void (*deleter)(void *);
+  };
+
+public:
+  static unsigned const slots_per_thread = 4;
+
+  struct thread_record;
+
+  hazard_pointer_domain() : records(nullptr), record_count(0) {
+  }
+
+  hazard_pointer_domain(const hazard_pointer_domain &) = delete;
+  hazard_pointer_domain &operator=(const hazard_pointer_domain &) = delete;
+
+  // 调用时不应再有线程访问该域，剩余的待回收节点全部直接释放
+  ~hazard_pointer_domain() {
+    thread_record *current = records.load();
+    while (current) {
+      thread_record *const next = current->next;
+      for (std::size_t i = 0; i < current->retired.size(); i++) {
+        current->retired[i].deleter(current->retired[i].pointer);
+      }
+      delete current;
+      current = next;
+    }
+  }
+
+  template <typename T>
+  void retire(T *p) {
+    retire(p, &do_delete<T>);
+  }
+
+  void retire(void *p, void (*deleter)(void *)) {
+    thread_record &record = this_thread_record();
+    record.retired.push_back(retired_node{p, deleter});
+    if (record.retired.size() >= scan_threshold()) {
+      scan(record);
+    }
+  }
+
+  // 当前线程在该域上的记录，首次调用时认领
+  thread_record &this_thread_record() {
+    thread_records &owned = owned_records();
+    for (std::size_t i = 0; i < owned.entries.size(); i++) {
+      if (owned.entries[i].first == this) {
+        return *owned.entries[i].second;
+      }
+    }
+    thread_record *const record = acquire_record();
+    owned.entries.push_back(std::make_pair(this, record));
+    return *record;
+  }
+
+  struct thread_record {
+    std::atomic<void *>       hazards[slots_per_thread];
+    unsigned                  used_mask;  // 以下成员仅由持有记录的线程访问
+    std::vector<retired_node> retired;
+    std::atomic<bool>         active;
+    thread_record            *next;  // 发布到链表后不再修改
+
+    thread_record() : used_mask(0), active(true), next(nullptr) {
+      for (unsigned i = 0; i < slots_per_thread; i++) {
+        hazards[i].store(nullptr);
+      }
+    }
+  };
+
+private:
+  // 线程退出时归还它在各个域上认领的记录
+  struct thread_records {
+    std::vector<std::pair<hazard_pointer_domain *, thread_record *>> entries;
+
+    ~thread_records() {
+      for (std::size_t i = 0; i < entries.size(); i++) {
+        entries[i].first->release_record(entries[i].second);
+      }
+    }
+  };
+
+  std::atomic<thread_record *> records;
+  std::atomic<unsigned>        record_count;
+
+  template <typename T>
+  static void do_delete(void *p) {
+    delete static_cast<T *>(p);
+  }
+
+  static thread_records &owned_records() {
+    thread_local thread_records owned;
+    return owned;
+  }
+
+  std::size_t scan_threshold() const {
+    return std::max<std::size_t>(
+        2 * static_cast<std::size_t>(record_count.load()) * slots_per_thread,
+        64);
+  }
+
+  thread_record *acquire_record() {
+    for (thread_record *current = records.load(); current;
+         current = current->next) {
+      bool expected = false;
+      if (!current->active.load() &&
+          current->active.compare_exchange_strong(expected, true)) {
+        return current;
+      }
+    }
+    thread_record *const record = new thread_record;
+    record->next                = records.load();
+    while (!records.compare_exchange_weak(record->next, record)) {
+    }
+    ++record_count;
+    return record;
+  }
+
+  void release_record(thread_record *record) {
+    for (unsigned i = 0; i < slots_per_thread; i++) {
+      record->hazards[i].store(nullptr);
+    }
+    record->used_mask = 0;
+    scan(*record);  // 释放能释放的，剩余的留给下一个认领该记录的线程
+    record->active.store(false);
+  }
+
+  void scan(thread_record &record) {
+    std::vector<void *> protected_pointers;
+    protected_pointers.reserve(record_count.load() * slots_per_thread);
+    for (thread_record *current = records.load(); current;
+         current = current->next) {
+      for (unsigned i = 0; i < slots_per_thread; i++) {
+        if (void *const p = current->hazards[i].load()) {
+          protected_pointers.push_back(p);
+        }
+      }
+    }
+    std::sort(protected_pointers.begin(), protected_pointers.end());
+
+    std::vector<retired_node> still_protected;
+    for (std::size_t i = 0; i < record.retired.size(); i++) {
+      retired_node const &node = record.retired[i];
+      if (std::binary_search(protected_pointers.begin(),
+                             protected_pointers.end(), node.pointer)) {
+        still_protected.push_back(node);
+      } else {
+        node.deleter(node.pointer);
+      }
+    }
+    record.retired.swap(still_protected);
+  }
+};
+
+inline hazard_pointer_domain &default_hazard_domain() {
+  static hazard_pointer_domain domain;
+  return domain;
+}
+
+// 占用当前线程记录中的一个风险指针槽位，析构时归还
+class hazard_pointer {
+public:
+  explicit hazard_pointer(
+      hazard_pointer_domain &domain = default_hazard_domain())
+      : record(domain.this_thread_record()), index(0) {
+    while (index < hazard_pointer_domain::slots_per_thread &&
+           (record.used_mask & (1u << index))) {
+      ++index;
+    }
+    if (index == hazard_pointer_domain::slots_per_thread) {
+      throw std::runtime_error("No hazard pointers available");
+    }
+    record.used_mask |= 1u << index;
+  }
+
+  hazard_pointer(hazard_pointer const &) = delete;
+  hazard_pointer &operator=(hazard_pointer const &) = delete;
+
+  ~hazard_pointer() {
+    record.hazards[index].store(nullptr);
+    record.used_mask &= ~(1u << index);
+  }
+
+  // 发布src当前的值并确认它没有在发布期间被替换
+  template <typename T>
+  T *protect(std::atomic<T *> const &src) {
+    T *p = src.load();
+    for (;;) {
+      record.hazards[index].store(p);
+      T *const current = src.load();
+      if (current == p) {
+        return p;
+      }
+      p = current;
+    }
+  }
+
+  void set(void *p) {
+    record.hazards[index].store(p);
+  }
+
+  void reset() {
+    record.hazards[index].store(nullptr);
+  }
+
+private:
+  hazard_pointer_domain::thread_record &record;
+  unsigned                              index;
+};
+
+#endif  // !_HAZARD_POINTER_H_
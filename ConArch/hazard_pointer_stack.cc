@@ -10,157 +10,12 @@
  */
 
 #include <atomic>
-#include <functional>
 #include <iostream>
 #include <memory>
 #include <thread>
+#include <vector>
 
-unsigned const max_hazard_pointers = 100;
-struct hazard_pointer {
-  std::atomic<std::thread::id> id;
-  std::atomic<void *>          pointer;
-};
-
-hazard_pointer hazard_pointers[max_hazard_pointers];
-
-class hp_owner {
-public:
-  hp_owner(hp_owner const &) = delete;
-  hp_owner &operator=(hp_owner const &) = delete;
-
-  hp_owner() : hp(nullptr) {
-    for (unsigned i = 0; i < max_hazard_pointers; i++) {
-      std::thread::id old_id;
-      if (hazard_pointers[i].id.compare_exchange_strong(
-              old_id, std::this_thread::get_id())) {
-        hp = &hazard_pointers[i];
-        break;
-      }
-    }
-    if (!hp) {
-      throw std::runtime_error("No hazard pointers available");
-    }
-  }
-
-  std::atomic<void *> &get_pointer() {
-    return hp->pointer;
-  }
-
-  ~hp_owner() {
-    hp->pointer.store(nullptr);
-    hp->id.store(std::thread::id());
-  }
-
-private:
-  hazard_pointer *hp;
-};
-
-std::atomic<void *> &get_hazard_pointer_for_current_thread() {
-  thread_local static hp_owner hazard;  // 每个线程都有自己的风险指针
-  return hazard.get_pointer();
-}
-
-bool outstanding_hazard_pointer_for(void *p) {
-  for (unsigned i = 0; i < max_hazard_pointers; i++) {
-    if (p == hazard_pointers[i].pointer.load()) {
-      return true;
-    }
-  }
-  return false;
-}
-
-template <typename T>
-void do_delete(void *p) {
-  delete static_cast<T *>(p);
-}
-
-struct data_to_reclaim {
-  void *                      data;
-  std::function<void(void *)> deleter;
-  data_to_reclaim *           next;
-
-  template <typename T>
-  data_to_reclaim(T *p) : data(p),
-                          deleter(&do_delete<T>),
-                          next(0) {
-  }
-
-  ~data_to_reclaim() {
-    deleter(data);
-  }
-};
-
-std::atomic<data_to_reclaim *> nodes_to_reclaim;
-void                           add_to_reclaim_list(data_to_reclaim *node) {
-  node->next = nodes_to_reclaim.load();
-  while (!nodes_to_reclaim.compare_exchange_weak(node->next, node)) {
-  }
-}
-
-template <typename T>
-void reclaim_later(T *data) {
-  add_to_reclaim_list(new data_to_reclaim(data));
-}
-
-void delete_nodes_with_no_hazards() {
-  data_to_reclaim *current = nodes_to_reclaim.exchange(nullptr);
-  while (current) {
-    data_to_reclaim *const next = current->next;
-    if (!outstanding_hazard_pointer_for(current->data)) {
-      delete current;
-    } else {
-      add_to_reclaim_list(current);
-    }
-    current = next;
-  }
-}
-
-template <typename T>
-class hazard_pointer_stack {
-public:
-  void push(T const &value) {
-    node *const new_node = new node(value);
-    new_node->next       = head.load();
-    while (!head.compare_exchange_weak(new_node->next, new_node)) {
-    }
-  }
-
-  std::shared_ptr<T> pop() {
-    std::atomic<void *> &hp       = get_hazard_pointer_for_current_thread();
-    node *               old_head = head.load();
-    do {
-      node *temp;
-      do {
-        temp = old_head;
-        hp.store(old_head);
-        old_head = head.load();
-      } while (old_head != temp);
-    } while (old_head &&
-             !head.compare_exchange_strong(old_head, old_head->next));
-    hp.store(nullptr);
-    std::shared_ptr<T> res;
-    if (old_head) {
-      res.swap(old_head->data);
-      if (outstanding_hazard_pointer_for(old_head)) {
-        reclaim_later(old_head);
-      } else {
-        delete old_head;
-      }
-      delete_nodes_with_no_hazards();
-    }
-    return res;
-  }
-
-private:
-  struct node {
-    std::shared_ptr<T> data;
-    node *             next;
-    node(T const &value) : data(std::make_shared<T>(value)) {
-    }
-  };
-
-  std::atomic<node *> head;
-};
+#include "hazard_pointer_stack.hpp"
 
 int main(int argc, char **argv) {
   std::shared_ptr<hazard_pointer_stack<int>> ptr =
@@ -168,4 +23,25 @@ int main(int argc, char **argv) {
   std::thread t{&hazard_pointer_stack<int>::push, ptr, std::move(3)};
   t.join();
   std::cout << *(ptr->pop()) << std::endl;
+
+  // 多线程同时push/pop，风险指针保证被弹出的节点不会在读取next时被释放
+  std::atomic<long>        popped(0);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < 4; i++) {
+    threads.push_back(std::thread([ptr, &popped] {
+      for (int j = 0; j < 100000; j++) {
+        ptr->push(j);
+        if (ptr->pop()) {
+          ++popped;
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  while (ptr->pop()) {
+    ++popped;
+  }
+  std::cout << "popped " << popped << " of " << 4 * 100000 << std::endl;
 }
@@ -0,0 +1,67 @@
+/**
+ * @file hazard_pointer_stack.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 使用风险指针实现的线程安全栈
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _HAZARD_POINTER_STACK_H_
+#define _HAZARD_POINTER_STACK_H_
+
+#include <atomic>
+#include <memory>
+
+#include "hazard_pointer.hpp"
+
+template <typename T>
+class hazard_pointer_stack {
+public:
+  hazard_pointer_stack() : head(nullptr) {
+  }
+
+  ~hazard_pointer_stack() {
+    while (node *const old_head = head.load()) {
+      head.store(old_head->next);
+      delete old_head;
+    }
+  }
+
+  void push(T const &value) {
+    node *const new_node = new node(value);
+    new_node->next       = head.load();
+    while (!head.compare_exchange_weak(new_node->next, new_node)) {
+    }
+  }
+
+  std::shared_ptr<T> pop() {
+    hazard_pointer hp;  // 每个线程都有自己的风险指针
+    node          *old_head;
+    do {
+      old_head = hp.protect(head);
+    } while (old_head &&
+             !head.compare_exchange_strong(old_head, old_head->next));
+    hp.reset();
+    std::shared_ptr<T> res;
+    if (old_head) {
+      res.swap(old_head->data);
+      default_hazard_domain().retire(old_head);
+    }
+    return res;
+  }
+
+private:
+  struct node {
+    std::shared_ptr<T> data;
+    node              *next;
+    node(T const &value) : data(std::make_shared<T>(value)), next(nullptr) {
+    }
+  };
+
+  std::atomic<node *> head;
+};
+
+#endif  // !_HAZARD_POINTER_STACK_H_
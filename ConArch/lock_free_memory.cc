@@ -1,98 +1,119 @@
 /**
- * @file lock_free_stack.cc
+ * @file lock_free_memory.cc
  * @author koritafei (koritafei@gmail.com)
- * @brief 无锁数据结构，stack,双计数+内存顺序
+ * @brief 无锁数据结构，stack，显式内存顺序 + 可选的内存回收策略
  * @version 0.1
  * @date 2020-08-12
  *
  * @copyright Copyright (c) 2020
  *
+ * 实现见lock_free_memory.hpp。
+ * main中对两种策略分别测试push/pop各半与读多写少(90% top)两种负载，
+ * 同时统计每次操作的堆分配次数。
  */
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <thread>
+#include <vector>
 
-template <typename T>
-class lock_free_stack {
-public:
-  ~lock_free_stack() {
-    while (pop()) {
-    }
-  }
+#include "Benchmark/alloc_counter.hpp"
+#include "lock_free_memory.hpp"
 
-  void push(T const &data) {
-    count_node_ptr new_node;
-    new_node.ptr            = new node(data);
-    new_node.external_count = 1;
-    new_node.ptr->next      = head.load();
-    while (!head.compare_exchange_weak(new_node.ptr->next, new_node,
-                                       std::memory_order_release,
-                                       std::memory_order_relaxed)) {
-    }
-  }
+struct bench_result {
+  double ops_per_second;
+  double allocs_per_op;
+};
 
-  std::shared_ptr<T> pop() {
-    count_node_ptr old_head = head.load(std::memory_order_relaxed);
-    for (;;) {
-      increase_head_count(old_head);
-      node *const ptr = old_head.ptr;
-      if (!ptr) {
-        return std::shared_ptr<T>();
+// 每个线程执行ops次操作，每10次中有read_tenths次top，其余push/pop交替
+template <typename Reclaimer>
+bench_result run_bench(unsigned threads, unsigned ops, unsigned read_tenths) {
+  lock_free_stack<int, Reclaimer> stack;
+  for (int i = 0; i < 1024; i++) {
+    stack.push(i);
+  }
+  std::vector<std::thread>   workers;
+  std::atomic<bool>          go(false);
+  std::atomic<std::uint64_t> allocations(0);
+  for (unsigned t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&stack, &go, &allocations, ops,
+                                   read_tenths] {
+      while (!go.load()) {
+        std::this_thread::yield();
       }
-      if (head.compare_exchange_strong(old_head, ptr->next,
-                                       std::memory_order_relaxed)) {
-        std::shared_ptr<T> res;
-        res.swap(ptr->data);
-        int const count_increase = old_head.external_count - 2;
-        if (ptr->internal_count.fetch_add(
-                count_increase, std::memory_order_relaxed) == -count_increase) {
-          delete ptr;
+      std::uint64_t const before    = thread_allocations();
+      bool                push_next = true;
+      int                 value     = 0;
+      for (unsigned i = 0; i < ops; i++) {
+        if (i % 10 < read_tenths) {
+          stack.top(value);
+        } else if (push_next) {
+          stack.push(static_cast<int>(i));
+          push_next = false;
+        } else {
+          stack.pop(value);
+          push_next = true;
         }
-        return res;
-      } else if (ptr->internal_count.fetch_add(-1, std::memory_order_relaxed) ==
-                 1) {
-        ptr->internal_count.load(std::memory_order_acquire);
-        delete ptr;
       }
-    }
+      allocations += thread_allocations() - before;
+    }));
   }
-
-private:
-  struct node;
-  struct count_node_ptr {
-    int   external_count;
-    node *ptr;
-  };
-
-  struct node {
-    std::shared_ptr<T> data;
-    std::atomic<int>   internal_count;
-    count_node_ptr     next;
-
-    node(T const &data_) : data(std::make_shared<T>(data_)), internal_count(0) {
-    }
-  };
-
-  std::atomic<count_node_ptr> head;
-
-  void increase_head_count(count_node_ptr &old_counter) {
-    count_node_ptr new_counter;
-    do {
-      new_counter = old_counter;
-      ++new_counter.external_count;
-    } while (!head.compare_exchange_strong(old_counter, new_counter,
-                                           std::memory_order_acquire,
-                                           std::memory_order_relaxed));
-    old_counter.external_count = new_counter.external_count;
+  auto const start = std::chrono::steady_clock::now();
+  go.store(true);
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
   }
-};
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  double const total = threads * static_cast<double>(ops);
+  bench_result result;
+  result.ops_per_second = total / elapsed.count();
+  result.allocs_per_op  = allocations.load() / total;
+  return result;
+}
 
 int main(int argc, char **argv) {
   std::shared_ptr<lock_free_stack<int>> ptr =
       std::make_shared<lock_free_stack<int>>();
   std::thread t{&lock_free_stack<int>::push, ptr, std::move(4)};
   t.join();
-  std::cout << *(ptr->pop()) << std::endl;
+  int value = 0;
+  ptr->pop(value);
+  std::cout << value << std::endl;
+
+  lock_free_stack<int, epoch_reclaimer> epoch_stack;
+  epoch_stack.push(5);
+  int top = 0;
+  epoch_stack.top(top);
+  epoch_stack.pop(value);
+  std::cout << top << " " << value << std::endl;
+
+  int const        items[] = {1, 2, 3, 4};
+  std::vector<int> drained;
+  epoch_stack.push_range(items, items + 4);
+  epoch_stack.pop_all(std::back_inserter(drained));
+  for (std::size_t i = 0; i < drained.size(); i++) {
+    std::cout << drained[i] << " ";
+  }
+  std::cout << std::endl;
+
+  unsigned const ops = 200000;
+  std::printf("%-8s %-10s %14s %10s %14s %10s\n", "threads", "workload",
+              "hazard ops/s", "allocs/op", "epoch ops/s", "allocs/op");
+  for (unsigned threads = 1; threads <= 8; threads *= 2) {
+    for (unsigned read_tenths = 0; read_tenths <= 9; read_tenths += 9) {
+      bench_result const hp =
+          run_bench<hazard_pointer_reclaimer>(threads, ops, read_tenths);
+      bench_result const ebr =
+          run_bench<epoch_reclaimer>(threads, ops, read_tenths);
+      std::printf("%-8u %-10s %14.0f %10.3f %14.0f %10.3f\n", threads,
+                  read_tenths ? "90% top" : "push/pop", hp.ops_per_second,
+                  hp.allocs_per_op, ebr.ops_per_second, ebr.allocs_per_op);
+    }
+  }
 }
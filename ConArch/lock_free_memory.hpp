@@ -0,0 +1,127 @@
+/**
+ * @file lock_free_memory.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 无锁数据结构，stack，显式内存顺序 + 可选的内存回收策略
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 回收策略由模板参数Reclaimer决定(见reclaimer.hpp)：
+ * hazard_pointer_reclaimer 或 epoch_reclaimer。
+ * 数据直接存放在节点中，节点从node_pool分配；
+ * push_range一次CAS发布整串节点，pop_all一次exchange摘下整个栈。
+ */
+
+#ifndef _LOCK_FREE_MEMORY_H_
+#define _LOCK_FREE_MEMORY_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "node_pool.hpp"
+#include "reclaimer.hpp"
+
+template <typename T, typename Reclaimer = hazard_pointer_reclaimer>
+class lock_free_stack {
+public:
+  lock_free_stack() : head(nullptr) {
+  }
+
+  lock_free_stack(const lock_free_stack &) = delete;
+  lock_free_stack &operator=(const lock_free_stack &) = delete;
+
+  ~lock_free_stack() {
+    node *current = head.load(std::memory_order_relaxed);
+    while (current) {
+      node *const next = current->next;
+      delete current;
+      current = next;
+    }
+  }
+
+  void push(T const &data) {
+    node *const new_node = new node(data);
+    new_node->next       = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(new_node->next, new_node,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  // 按[first, last)的顺序压栈，最后一个元素位于栈顶
+  template <typename InputIterator>
+  void push_range(InputIterator first, InputIterator last) {
+    if (first == last) {
+      return;
+    }
+    node *const bottom = new node(*first);
+    node       *top    = bottom;
+    for (++first; first != last; ++first) {
+      node *const n = new node(*first);
+      n->next       = top;
+      top           = n;
+    }
+    bottom->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(bottom->next, top,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  bool pop(T &value) {
+    typename Reclaimer::guard guard;
+    node                     *old_head = guard.protect(head);
+    while (old_head &&
+           !head.compare_exchange_weak(old_head, old_head->next,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      old_head = guard.protect(head);
+    }
+    if (!old_head) {
+      return false;
+    }
+    // 节点可能仍在被top读取，数据只复制不移走
+    value = old_head->data;
+    Reclaimer::retire(old_head);
+    return true;
+  }
+
+  bool top(T &value) {
+    typename Reclaimer::guard guard;
+    node *const               current = guard.protect(head);
+    if (!current) {
+      return false;
+    }
+    value = current->data;
+    return true;
+  }
+
+  // 摘下整个栈，按出栈顺序写入out，返回元素个数
+  template <typename OutputIterator>
+  std::size_t pop_all(OutputIterator out) {
+    node       *current = head.exchange(nullptr, std::memory_order_acquire);
+    std::size_t count   = 0;
+    while (current) {
+      node *const next = current->next;
+      *out++           = current->data;
+      Reclaimer::retire(current);
+      current = next;
+      ++count;
+    }
+    return count;
+  }
+
+private:
+  struct node : pooled<node> {
+    T const data;
+    node   *next;
+
+    node(T const &data_) : data(data_), next(nullptr) {
+    }
+  };
+
+  std::atomic<node *> head;
+};
+
+#endif  // !_LOCK_FREE_MEMORY_H_
@@ -1,90 +1,228 @@
 /**
  * @file lock_free_stack.cc
  * @author koritafei (koritafei@gmail.com)
- * @brief 无锁数据结构，stack,双计数法
+ * @brief 无锁数据结构，stack,双计数法 + 消除退避数组
  * @version 0.1
  * @date 2020-08-12
  *
  * @copyright Copyright (c) 2020
  *
+ * 实现见lock_free_stack.hpp，main中做守恒检查并比较三种head/消除组合的吞吐。
  */
 
 #include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <thread>
+#include <vector>
 
-template <typename T>
-class lock_free_stack {
-public:
-  ~lock_free_stack() {
-    while (pop()) {
-    }
-  }
+#include "Benchmark/alloc_counter.hpp"
+#include "lock_free_stack.hpp"
 
-  void push(T const &data) {
-    count_node_ptr new_node;
-    new_node.ptr            = new node(data);
-    new_node.external_count = 1;
-    new_node.ptr->next      = head.load();
-    while (!head.compare_exchange_weak(new_node.ptr->next, new_node)) {
-    }
-  }
+struct bench_result {
+  double ops_per_second;
+  double allocs_per_op;
+};
 
-  std::shared_ptr<T> pop() {
-    count_node_ptr old_head = head.load();
-    for (;;) {
-      increase_head_count(old_head);
-      node *const ptr = old_head.ptr;
-      if (!ptr) {
-        return std::shared_ptr<T>();
+// 每个线程交替push/pop共ops次
+template <template <typename> class Head>
+bench_result run_bench(unsigned elimination_slots,
+                       unsigned threads,
+                       unsigned ops) {
+  lock_free_stack<int, Head> stack(elimination_slots);
+  std::vector<std::thread>   workers;
+  std::atomic<bool>          go(false);
+  std::atomic<std::uint64_t> allocations(0);
+  for (unsigned t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&stack, &go, &allocations, ops] {
+      while (!go.load()) {
+        std::this_thread::yield();
       }
-      if (head.compare_exchange_strong(old_head, ptr->next)) {
-        std::shared_ptr<T> res;
-        res.swap(ptr->data);
-        int const count_increase = old_head.external_count - 2;
-        if (ptr->internal_count.fetch_add(count_increase) == -count_increase) {
-          delete ptr;
+      std::uint64_t const before = thread_allocations();
+      for (unsigned i = 0; i < ops; i++) {
+        if (i % 2 == 0) {
+          stack.push(static_cast<int>(i));
+        } else {
+          int value;
+          stack.pop(value);
         }
-        return res;
-      } else if (ptr->internal_count.fetch_sub(1) == 1) {
-        delete ptr;
       }
-    }
+      allocations += thread_allocations() - before;
+    }));
   }
+  auto const start = std::chrono::steady_clock::now();
+  go.store(true);
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  double const total = threads * static_cast<double>(ops);
+  bench_result result;
+  result.ops_per_second = total / elapsed.count();
+  result.allocs_per_op  = allocations.load() / total;
+  return result;
+}
 
-private:
-  struct node;
-  struct count_node_ptr {
-    int   external_count;
-    node *ptr;
-  };
-
-  struct node {
-    std::shared_ptr<T> data;
-    std::atomic<int>   internal_count;
-    count_node_ptr     next;
+// 弹出时的CAS先失败contended_failures次，相当于其他线程不断抢先给栈顶
+// 加计数，栈顶节点的16位外部计数因而回绕
+unsigned contended_failures = 0;
 
-    node(T const &data_) : data(std::make_shared<T>(data_)), internal_count(0) {
+template <typename CountedPtr>
+class contended_head : public packed_counted_head<CountedPtr> {
+public:
+  bool compare_exchange_strong(CountedPtr &expected, CountedPtr desired) {
+    if (contended_failures > 0 && desired.ptr != expected.ptr) {
+      --contended_failures;
+      expected = this->load();
+      return false;
     }
-  };
+    return packed_counted_head<CountedPtr>::compare_exchange_strong(expected,
+                                                                    desired);
+  }
+};
 
-  std::atomic<count_node_ptr> head;
+// 记录存活对象数，节点被释放时其中的data随之析构
+struct tracked {
+  static std::atomic<int> live;
+  int                     value;
 
-  void increase_head_count(count_node_ptr &old_counter) {
-    count_node_ptr new_counter;
-    do {
-      new_counter = old_counter;
-      ++new_counter.external_count;
-    } while (!head.compare_exchange_strong(old_counter, new_counter));
-    old_counter.external_count = new_counter.external_count;
+  tracked(int value_) : value(value_) {
+    ++live;
+  }
+  tracked(tracked const &other) : value(other.value) {
+    ++live;
+  }
+  ~tracked() {
+    --live;
   }
 };
 
+std::atomic<int> tracked::live(0);
+
+void print_result(unsigned threads, char const *name, bench_result r) {
+  std::printf("%-8u %-20s %14.0f %10.3f\n", threads, name, r.ops_per_second,
+              r.allocs_per_op);
+}
+
 int main(int argc, char **argv) {
   std::shared_ptr<lock_free_stack<int>> ptr =
       std::make_shared<lock_free_stack<int>>();
   std::thread t{&lock_free_stack<int>::push, ptr, std::move(4)};
   t.join();
-  std::cout << *(ptr->pop()) << std::endl;
+  int value = 0;
+  ptr->pop(value);
+  std::cout << value << std::endl;
+
+  // 空栈上反复pop：空头的外部计数不应增长(打包的计数只有16位)
+  {
+    lock_free_stack<int> empty;
+    bool                 ok = true;
+    for (int i = 0; i < 200000; i++) {
+      ok = !empty.pop(value) && ok;
+    }
+    empty.push(7);
+    ok = empty.pop(value) && value == 7 && !empty.pop(value) && ok;
+    std::cout << "empty pops " << (ok ? "ok" : "failed") << std::endl;
+  }
+
+  // 外部计数回绕之后，弹出的节点仍恰好释放一次
+  {
+    bool ok = true;
+    {
+      lock_free_stack<tracked, contended_head> contended(0);
+      contended.push(tracked(1));
+      contended.push(tracked(2));
+      for (int expected = 2; expected >= 1; expected--) {
+        contended_failures = 70000;
+        tracked popped(0);
+        ok = contended.pop(popped) && popped.value == expected && ok;
+      }
+      ok = tracked::live.load() == 0 && ok;
+    }
+    std::cout << "wrapped counts " << (ok ? "ok" : "failed") << std::endl;
+  }
+
+  // 多线程并发push/pop后，所有元素都应恰好被弹出一次
+  lock_free_stack<int>     stack;
+  std::atomic<long>        sum(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.push_back(std::thread([&stack, &sum, i] {
+      for (int j = 0; j < 50000; j++) {
+        stack.push(i * 50000 + j);
+        int value = 0;
+        if (stack.pop(value)) {
+          sum += value;
+        }
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  while (stack.pop(value)) {
+    sum += value;
+  }
+  long const expected = 200000L * 199999L / 2;
+  std::cout << "sum " << sum.load() << (sum == expected ? " ok" : " mismatch")
+            << std::endl;
+
+  // 生产者每次用push_range压入一批，消费者用pop_all整栈取走
+  std::atomic<bool> producing(true);
+  long              drained = 0;
+  std::vector<int>  batch;
+
+  std::thread consumer([&stack, &producing, &drained, &batch] {
+    for (;;) {
+      bool const last = !producing.load();
+      stack.pop_all(std::back_inserter(batch));
+      if (last) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+    for (std::size_t i = 0; i < batch.size(); i++) {
+      drained += batch[i];
+    }
+  });
+  threads.clear();
+  for (int i = 0; i < 4; i++) {
+    threads.push_back(std::thread([&stack, i] {
+      std::vector<int> items(100);
+      for (int j = 0; j < 500; j++) {
+        for (int k = 0; k < 100; k++) {
+          items[k] = i * 50000 + j * 100 + k;
+        }
+        stack.push_range(items.begin(), items.end());
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  producing.store(false);
+  consumer.join();
+  std::cout << "batched " << batch.size() << " sum " << drained
+            << (drained == expected ? " ok" : " mismatch") << std::endl;
+
+  assert(stack.is_lock_free());
+  std::cout << "wide head lock free: " << std::boolalpha
+            << lock_free_stack<int, wide_counted_head>().is_lock_free()
+            << ", packed head lock free: " << stack.is_lock_free() << std::endl;
+
+  unsigned const ops = 200000;
+  std::printf("%-8s %-20s %14s %10s\n", "threads", "variant", "ops/s",
+              "allocs/op");
+  for (unsigned n = 1; n <= 8; n *= 2) {
+    print_result(n, "wide head", run_bench<wide_counted_head>(0, n, ops));
+    print_result(n, "packed head", run_bench<packed_counted_head>(0, n, ops));
+    print_result(n, "packed+elimination",
+                 run_bench<packed_counted_head>(8, n, ops));
+  }
 }
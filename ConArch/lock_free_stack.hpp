@@ -0,0 +1,403 @@
+/**
+ * @file lock_free_stack.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 无锁数据结构，stack,双计数法 + 消除退避数组
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * head上的CAS失败说明栈正被争用，此时不立即重试，而是到消除数组里
+ * 随机挑一个槽位：push把节点放进槽位等待片刻，pop在槽位上等待节点出现，
+ * 一对push/pop在槽位上相遇就直接交换数据，双方都不用再碰head。
+ * 每个线程的挑选范围自适应：交换成功就扩大，超时就缩小。
+ *
+ * 带计数的head有两种表示，作为模板参数Head传入：
+ *  - wide_counted_head: 16字节结构体直接放进std::atomic，GCC会转给libatomic，
+ *    通常用锁实现，并不是真正的无锁；
+ *  - packed_counted_head(默认): 把外部计数放进指针的高16位，
+ *    整体是一个64位原子量，在x86-64和AArch64上都保证无锁。
+ *    用户态地址只用低48位(Linux上除非mmap显式要求高地址)，
+ *    但不能与占用指针高位的HWASan/MTE同时使用。
+ * 外部计数只有16位：pop失败时计数不回退，压栈时又随head复制进新节点的next，
+ * 节点多次回到栈顶会一直累积，所以两种表示都按2^16取模递增。
+ * 内部计数也只看低16位，另有一位标记外部计数是否已经转入：
+ * 转入之后低16位恰好是其他仍持有引用的线程数(远小于2^16)，归零即可释放，
+ * 计数回绕不会让节点被提前释放。
+ *
+ * 数据直接存放在节点中，节点从node_pool分配，稳态下push/pop不调用malloc。
+ * push_range先在本地把一串节点链好，再用一次CAS整串发布；
+ * pop_all用一次CAS把整个栈摘下来，适合成批消费。
+ */
+
+#ifndef _LOCK_FREE_STACK_H_
+#define _LOCK_FREE_STACK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "node_pool.hpp"
+
+// 16字节的std::atomic<CountedPtr>，依赖libatomic
+template <typename CountedPtr>
+class wide_counted_head {
+public:
+  CountedPtr load() const {
+    return value.load();
+  }
+
+  void store(CountedPtr desired) {
+    value.store(desired);
+  }
+
+  bool compare_exchange_weak(CountedPtr &expected, CountedPtr desired) {
+    return value.compare_exchange_weak(expected, desired);
+  }
+
+  bool compare_exchange_strong(CountedPtr &expected, CountedPtr desired) {
+    return value.compare_exchange_strong(expected, desired);
+  }
+
+  bool is_lock_free() const {
+    return value.is_lock_free();
+  }
+
+private:
+  std::atomic<CountedPtr> value;
+};
+
+// 外部计数占高16位、指针占低48位的64位原子量
+template <typename CountedPtr>
+class packed_counted_head {
+  static_assert(sizeof(void *) == 8,
+                "packed_counted_head needs 64-bit pointers");
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+                "64-bit atomics must be lock-free for packed_counted_head");
+
+  typedef decltype(CountedPtr().ptr) pointer;
+
+public:
+  CountedPtr load() const {
+    return unpack(value.load());
+  }
+
+  void store(CountedPtr desired) {
+    value.store(pack(desired));
+  }
+
+  bool compare_exchange_weak(CountedPtr &expected, CountedPtr desired) {
+    std::uint64_t packed = pack(expected);
+    if (value.compare_exchange_weak(packed, pack(desired))) {
+      return true;
+    }
+    expected = unpack(packed);
+    return false;
+  }
+
+  bool compare_exchange_strong(CountedPtr &expected, CountedPtr desired) {
+    std::uint64_t packed = pack(expected);
+    if (value.compare_exchange_strong(packed, pack(desired))) {
+      return true;
+    }
+    expected = unpack(packed);
+    return false;
+  }
+
+  bool is_lock_free() const {
+    return value.is_lock_free();
+  }
+
+private:
+  static unsigned const      pointer_bits = 48;
+  static std::uint64_t const pointer_mask =
+      (std::uint64_t(1) << pointer_bits) - 1;
+
+  std::atomic<std::uint64_t> value;
+
+  static std::uint64_t pack(CountedPtr const &counted) {
+    std::uint64_t const p = reinterpret_cast<std::uintptr_t>(counted.ptr);
+    assert((p & ~pointer_mask) == 0);
+    assert(counted.external_count >= 0 && counted.external_count < 0x10000);
+    return (static_cast<std::uint64_t>(counted.external_count)
+            << pointer_bits) |
+           p;
+  }
+
+  static CountedPtr unpack(std::uint64_t packed) {
+    CountedPtr counted;
+    counted.external_count = static_cast<int>(packed >> pointer_bits);
+    counted.ptr            = reinterpret_cast<pointer>(
+        static_cast<std::uintptr_t>(packed & pointer_mask));
+    return counted;
+  }
+};
+
+template <typename T, template <typename> class Head = packed_counted_head>
+class lock_free_stack {
+public:
+  // elimination_slots为0时关闭消除数组
+  explicit lock_free_stack(unsigned elimination_slots = 8)
+      : elimination(elimination_slots) {
+    count_node_ptr empty;
+    empty.external_count = 0;
+    empty.ptr            = nullptr;
+    head.store(empty);
+  }
+
+  bool is_lock_free() const {
+    return head.is_lock_free();
+  }
+
+  lock_free_stack(const lock_free_stack &) = delete;
+  lock_free_stack &operator=(const lock_free_stack &) = delete;
+
+  ~lock_free_stack() {
+    node *current = head.load().ptr;
+    while (current) {
+      node *const next = current->next.ptr;
+      delete current;
+      current = next;
+    }
+  }
+
+  void push(T const &data) {
+    count_node_ptr new_node;
+    new_node.ptr            = new node(data);
+    new_node.external_count = 1;
+    new_node.ptr->next      = head.load();
+    while (!head.compare_exchange_weak(new_node.ptr->next, new_node)) {
+      if (try_eliminate_push(new_node.ptr)) {
+        return;
+      }
+    }
+  }
+
+  // 按[first, last)的顺序压栈，最后一个元素位于栈顶
+  template <typename InputIterator>
+  void push_range(InputIterator first, InputIterator last) {
+    if (first == last) {
+      return;
+    }
+    node *const    bottom = new node(*first);
+    count_node_ptr top;
+    top.ptr            = bottom;
+    top.external_count = 1;
+    for (++first; first != last; ++first) {
+      node *const n = new node(*first);
+      n->next       = top;
+      top.ptr       = n;
+    }
+    bottom->next = head.load();
+    while (!head.compare_exchange_weak(bottom->next, top)) {
+    }
+  }
+
+  bool pop(T &value) {
+    count_node_ptr old_head = head.load();
+    for (;;) {
+      if (!increase_head_count(old_head)) {
+        return false;
+      }
+      node *const ptr = old_head.ptr;
+      if (head.compare_exchange_strong(old_head, ptr->next)) {
+        // 其他线程只会访问计数，不会访问data，可以直接移走
+        value = std::move(ptr->data);
+        if (transfer_count(ptr, old_head.external_count - 2)) {
+          delete ptr;
+        }
+        return true;
+      } else if (released(ptr->internal_count.fetch_sub(1) - 1)) {
+        delete ptr;
+      }
+      if (node *const exchanged = try_eliminate_pop()) {
+        // 交换得到的节点从未进入栈中，由当前线程独占
+        value = std::move(exchanged->data);
+        delete exchanged;
+        return true;
+      }
+    }
+  }
+
+  // 摘下整个栈，按出栈顺序写入out，返回元素个数
+  template <typename OutputIterator>
+  std::size_t pop_all(OutputIterator out) {
+    count_node_ptr empty;
+    empty.external_count = 0;
+    empty.ptr            = nullptr;
+
+    count_node_ptr current = head.load();
+    while (!head.compare_exchange_weak(current, empty)) {
+    }
+    std::size_t count = 0;
+    while (node *const ptr = current.ptr) {
+      count_node_ptr const next = ptr->next;
+      *out++                    = std::move(ptr->data);
+      // 与pop相同的计数转移，只是当前线程没有给外部计数加一
+      if (transfer_count(ptr, current.external_count - 1)) {
+        delete ptr;
+      }
+      current = next;
+      ++count;
+    }
+    return count;
+  }
+
+private:
+  struct node;
+  struct count_node_ptr {
+    int   external_count;
+    node *ptr;
+  };
+
+  // 外部计数按count_mask取模。内部计数从internal_bias开始，转入前只减不加，
+  // 偏置保证它不会借位到transferred；转入时加上transferred
+  static std::uint64_t const count_mask    = 0xFFFF;
+  static std::uint64_t const internal_bias = std::uint64_t(1) << 61;
+  static std::uint64_t const transferred   = std::uint64_t(1) << 62;
+
+  struct node : pooled<node> {
+    T                          data;
+    std::atomic<std::uint64_t> internal_count;
+    count_node_ptr             next;
+
+    node(T const &data_) : data(data_), internal_count(internal_bias) {
+    }
+  };
+
+  // 槽位状态：nullptr空闲，taken()已被pop取走，其他值为等待中的push节点
+  struct elimination_slot {
+    std::atomic<node *> value;
+    char                padding[64];
+    elimination_slot() : value(nullptr) {
+    }
+  };
+
+  static unsigned const elimination_spins = 128;
+
+  Head<count_node_ptr>          head;
+  std::vector<elimination_slot> elimination;
+
+  static node *taken() {
+    return reinterpret_cast<node *>(std::uintptr_t(1));
+  }
+
+  static std::uint32_t this_thread_random() {
+    thread_local std::uint32_t state = static_cast<std::uint32_t>(
+        std::hash<std::thread::id>()(std::this_thread::get_id()) | 1);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  // 本线程在消除数组中的挑选范围
+  static unsigned &this_thread_range() {
+    thread_local unsigned range = 1;
+    return range;
+  }
+
+  elimination_slot *pick_slot() {
+    if (elimination.empty()) {
+      return nullptr;
+    }
+    unsigned &range = this_thread_range();
+    range = std::min<unsigned>(std::max(range, 1u), elimination.size());
+    return &elimination[this_thread_random() % range];
+  }
+
+  static void on_exchange(bool succeeded, unsigned limit) {
+    unsigned &range = this_thread_range();
+    if (succeeded) {
+      range = std::min(range * 2, limit);
+    } else if (range > 1) {
+      --range;
+    }
+  }
+
+  bool try_eliminate_push(node *n) {
+    elimination_slot *const slot = pick_slot();
+    if (!slot) {
+      return false;
+    }
+    node *expected = nullptr;
+    if (!slot->value.compare_exchange_strong(expected, n)) {
+      return false;
+    }
+    for (unsigned i = 0; i < elimination_spins; i++) {
+      if (slot->value.load(std::memory_order_acquire) == taken()) {
+        slot->value.store(nullptr);
+        on_exchange(true, elimination.size());
+        return true;
+      }
+      if (i % 32 == 31) {
+        std::this_thread::yield();
+      }
+    }
+    expected = n;
+    if (slot->value.compare_exchange_strong(expected, nullptr)) {
+      on_exchange(false, elimination.size());
+      return false;
+    }
+    // 撤回失败说明pop刚刚取走了节点
+    slot->value.store(nullptr);
+    on_exchange(true, elimination.size());
+    return true;
+  }
+
+  node *try_eliminate_pop() {
+    elimination_slot *const slot = pick_slot();
+    if (!slot) {
+      return nullptr;
+    }
+    for (unsigned i = 0; i < elimination_spins; i++) {
+      node *n = slot->value.load(std::memory_order_acquire);
+      if (n && n != taken() &&
+          slot->value.compare_exchange_strong(n, taken())) {
+        on_exchange(true, elimination.size());
+        return n;
+      }
+      if (i % 32 == 31) {
+        std::this_thread::yield();
+      }
+    }
+    on_exchange(false, elimination.size());
+    return nullptr;
+  }
+
+  // 已转入且没有其他线程持有引用
+  static bool released(std::uint64_t internal) {
+    return (internal & transferred) && (internal & count_mask) == 0;
+  }
+
+  // 把弹出时的外部计数(减去调用者自身的引用)转入内部计数，返回能否释放
+  static bool transfer_count(node *ptr, int count_increase) {
+    std::uint64_t const add =
+        transferred + (static_cast<std::uint64_t>(count_increase) & count_mask);
+    return released(ptr->internal_count.fetch_add(add) + add);
+  }
+
+  // 栈为空时返回false且不加计数，否则空栈上的每次pop都会让空头的计数
+  // 只增不减
+  bool increase_head_count(count_node_ptr &old_counter) {
+    count_node_ptr new_counter;
+    do {
+      if (!old_counter.ptr) {
+        return false;
+      }
+      new_counter                = old_counter;
+      new_counter.external_count =
+          static_cast<int>((old_counter.external_count + 1) & count_mask);
+    } while (!head.compare_exchange_strong(old_counter, new_counter));
+    old_counter.external_count = new_counter.external_count;
+    return true;
+  }
+};
+
+#endif  // !_LOCK_FREE_STACK_H_
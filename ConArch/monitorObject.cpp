@@ -6,59 +6,7 @@
 #include <random>
 #include <thread>
 
-template <typename T>
-class Monitor {
-public:
-  void lock() const {
-    monitMutex.lock();
-  }
-
-  void unlock() const {
-    monitMutex.unlock();
-  }
-
-  void notify_one() const noexcept {
-    monitCond.notify_one();
-  }
-
-  void wait() const {
-    std::unique_lock<std::recursive_mutex> lock{monitMutex};
-    monitCond.wait(lock);
-  }
-
-private:
-  mutable std::recursive_mutex        monitMutex;
-  mutable std::condition_variable_any monitCond;
-};
-
-template <typename T>
-class ThreadSafeQueue : public Monitor<ThreadSafeQueue<T>> {
-public:
-  void add(T val) {
-    derived.lock();
-    _myQueue.push_back(val);
-    derived.unlock();
-    derived.notify_one();
-  }
-
-  T get() {
-    derived.lock();
-    while (_myQueue.empty()) {
-      derived.wait();
-    }
-
-    auto val = _myQueue.front();
-    _myQueue.pop_front();
-
-    derived.unlock();
-
-    return val;
-  }
-
-private:
-  std::deque<T>       _myQueue;
-  ThreadSafeQueue<T> &derived = static_cast<ThreadSafeQueue<T> &>(*this);
-};
+#include "monitor_queue.hpp"
 
 class Dice {
 public:
@@ -0,0 +1,76 @@
+/**
+ * @file monitor_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 监视器对象模式实现的线程安全队列
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _MONITOR_QUEUE_H_
+#define _MONITOR_QUEUE_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+template <typename T>
+class Monitor {
+public:
+  void lock() const {
+    monitMutex.lock();
+  }
+
+  void unlock() const {
+    monitMutex.unlock();
+  }
+
+  void notify_one() const noexcept {
+    monitCond.notify_one();
+  }
+
+  // 调用方已经通过lock()持有锁，这里接管而不是再次加锁，
+  // 否则递归锁计数为2，wait只释放一层，其他线程永远拿不到锁
+  void wait() const {
+    std::unique_lock<std::recursive_mutex> lock{monitMutex, std::adopt_lock};
+    monitCond.wait(lock);
+    lock.release();
+  }
+
+private:
+  mutable std::recursive_mutex        monitMutex;
+  mutable std::condition_variable_any monitCond;
+};
+
+template <typename T>
+class ThreadSafeQueue : public Monitor<ThreadSafeQueue<T>> {
+public:
+  void add(T val) {
+    derived.lock();
+    _myQueue.push_back(val);
+    derived.unlock();
+    derived.notify_one();
+  }
+
+  T get() {
+    derived.lock();
+    while (_myQueue.empty()) {
+      derived.wait();
+    }
+
+    auto val = _myQueue.front();
+    _myQueue.pop_front();
+
+    derived.unlock();
+
+    return val;
+  }
+
+private:
+  std::deque<T>       _myQueue;
+  ThreadSafeQueue<T> &derived = static_cast<ThreadSafeQueue<T> &>(*this);
+};
+
+#endif  // !_MONITOR_QUEUE_H_
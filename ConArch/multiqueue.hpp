@@ -0,0 +1,164 @@
+/**
+ * @file multiqueue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 松弛的并发优先队列(MultiQueue)：分片小顶堆 + 两次随机选择出队
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * push随机选择一个未被占用的分片入堆；pop_min随机选取两个分片，
+ * 比较堆顶后从较小的一个出队。返回值不保证是全局最小，
+ * 但大概率落在全局前O(分片数)个元素之内，换来接近线性的扩展性。
+ */
+
+#ifndef _MULTIQUEUE_H_
+#define _MULTIQUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+template <typename T, typename Compare = std::less<T>>
+class multiqueue {
+public:
+  // 分片数默认取硬件线程数的两倍，降低两个线程选中同一分片的概率
+  explicit multiqueue(unsigned num_shards = 2 *
+                                            std::thread::hardware_concurrency(),
+                      Compare const &compare_ = Compare())
+      : compare(compare_), waiters(0) {
+    if (num_shards < 2) {
+      num_shards = 2;
+    }
+    for (unsigned i = 0; i < num_shards; i++) {
+      shards.push_back(std::unique_ptr<shard>(new shard(compare)));
+    }
+  }
+
+  multiqueue(const multiqueue &) = delete;
+  multiqueue &operator=(const multiqueue &) = delete;
+
+  void push(T value) {
+    for (;;) {
+      shard &s = *shards[random() % shards.size()];
+      std::unique_lock<std::mutex> lk{s.mutex, std::try_to_lock};
+      if (!lk) {
+        continue;
+      }
+      s.heap.push(std::move(value));
+      s.size.fetch_add(1);
+      break;
+    }
+    if (waiters.load() > 0) {
+      std::lock_guard<std::mutex> lk{wait_mutex};
+      wait_con.notify_one();
+    }
+  }
+
+  bool try_pop_min(T &value) {
+    std::size_t const n = shards.size();
+    for (unsigned attempt = 0; attempt < n; attempt++) {
+      std::size_t const i = random() % n;
+      std::size_t       j = random() % n;
+      if (i == j) {
+        j = (j + 1) % n;
+      }
+      std::unique_lock<std::mutex> lk_i{shards[i]->mutex, std::try_to_lock};
+      if (!lk_i) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lk_j{shards[j]->mutex, std::try_to_lock};
+      shard *best = shards[i]->heap.empty() ? nullptr : shards[i].get();
+      if (lk_j && !shards[j]->heap.empty() &&
+          (!best || compare(shards[j]->heap.top(), best->heap.top()))) {
+        best = shards[j].get();
+      }
+      if (best) {
+        take_top(*best, value);
+        return true;
+      }
+    }
+    // 随机选择持续落空时逐个分片加锁检查，保证非空时一定能取到
+    for (std::size_t i = 0; i < n; i++) {
+      shard &s = *shards[i];
+      if (s.size.load() <= 0) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lk{s.mutex};
+      if (!s.heap.empty()) {
+        take_top(s, value);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void pop_min(T &value) {
+    while (!try_pop_min(value)) {
+      std::unique_lock<std::mutex> lk{wait_mutex};
+      waiters.fetch_add(1);
+      wait_con.wait(lk, [this] {
+        return !empty();
+      });
+      waiters.fetch_sub(1);
+    }
+  }
+
+  bool empty() const {
+    for (std::size_t i = 0; i < shards.size(); i++) {
+      if (shards[i]->size.load() > 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  // std::priority_queue默认是大顶堆，交换比较参数得到小顶堆
+  struct reverse_compare {
+    Compare compare;
+    bool    operator()(T const &lhs, T const &rhs) const {
+      return compare(rhs, lhs);
+    }
+  };
+
+  struct shard {
+    std::mutex                                           mutex;
+    std::priority_queue<T, std::vector<T>, reverse_compare> heap;
+    std::atomic<long>                                    size;
+    char padding[64];  // 避免相邻分片之间的伪共享
+    explicit shard(Compare const &compare)
+        : heap(reverse_compare{compare}), size(0) {
+    }
+  };
+
+  Compare                             compare;
+  std::vector<std::unique_ptr<shard>> shards;
+  std::atomic<unsigned>               waiters;
+  std::mutex                          wait_mutex;
+  std::condition_variable             wait_con;
+
+  static void take_top(shard &s, T &value) {
+    // priority_queue::top只给出const引用，这里借助const_cast移动出堆顶
+    value = std::move(const_cast<T &>(s.heap.top()));
+    s.heap.pop();
+    s.size.fetch_sub(1);
+  }
+
+  static std::uint32_t random() {
+    static std::atomic<std::uint32_t> seed(0);
+    thread_local std::uint32_t state = 2463534242u + seed.fetch_add(1);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+};
+
+#endif  // !_MULTIQUEUE_H_
@@ -0,0 +1,259 @@
+/**
+ * @file node_pool.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 无锁结构的定长节点池：线程本地缓存 + 带ABA标签的全局Treiber空闲链表
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 每种(大小, 对齐)对应一个node_pool单例，块从一次分配batch_size块的chunk中切出；
+ * - 分配与释放先走线程本地缓存，不需要任何原子操作；
+ * - 本地缓存为空时从全局链表整批取batch_size块，超过2 * batch_size块时
+ *   整批归还，全局链表每个节点是一批块，一次CAS搬运一批；
+ * - 全局链表头是64位原子量：低48位为指针，高16位为每次修改加一的标签，防止ABA；
+ * - 块头(链表指针)与节点存储分开，块内存永不还给系统，
+ *   因此并发pop读到已被别人取走的块头也是安全的，只会导致CAS失败。
+ * 节点类型继承pooled<node>即可让new/delete走节点池；
+ * pool_allocator可配合std::allocate_shared把shared_ptr的控制块也放进池中。
+ */
+
+#ifndef _NODE_POOL_H_
+#define _NODE_POOL_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+template <std::size_t Size, std::size_t Align>
+class node_pool {
+  static_assert(Align <= alignof(std::max_align_t),
+                "node_pool chunks are only max_align_t aligned");
+  static_assert(sizeof(void *) == 8, "node_pool packs tags into 64-bit words");
+
+  struct block {
+    std::atomic<block *> next;        // 同一批内的下一块
+    std::atomic<block *> next_batch;  // 全局链表中的下一批，仅批首有效
+  };
+
+  struct chunk {
+    chunk *next;
+  };
+
+  static std::size_t const align =
+      Align > alignof(block) ? Align : alignof(block);
+  static std::size_t const header_size =
+      (sizeof(block) + align - 1) / align * align;
+  static std::size_t const block_size =
+      (header_size + Size + align - 1) / align * align;
+  static std::size_t const chunk_header_size =
+      (sizeof(chunk) + alignof(std::max_align_t) - 1) /
+      alignof(std::max_align_t) * alignof(std::max_align_t);
+
+  static unsigned const      pointer_bits = 48;
+  static std::uint64_t const pointer_mask =
+      (std::uint64_t(1) << pointer_bits) - 1;
+
+public:
+  static std::size_t const batch_size = 64;
+
+  // 单例永不析构，退出时仍可能有静态对象把节点还回来
+  static node_pool &instance() {
+    static node_pool *const pool = new node_pool;
+    return *pool;
+  }
+
+  void *allocate() {
+    thread_cache &cache = local_cache();
+    if (!cache.head) {
+      refill(cache);
+    }
+    block *const b = cache.head;
+    cache.head     = b->next.load(std::memory_order_relaxed);
+    --cache.count;
+    return reinterpret_cast<char *>(b) + header_size;
+  }
+
+  void deallocate(void *p) {
+    block *const b =
+        reinterpret_cast<block *>(static_cast<char *>(p) - header_size);
+    thread_cache &cache = local_cache();
+    if (!cache.alive) {
+      // 本线程缓存已析构(如退出阶段静态对象释放节点)，直接还给全局链表
+      b->next.store(nullptr, std::memory_order_relaxed);
+      push_batch(b);
+      return;
+    }
+    b->next.store(cache.head, std::memory_order_relaxed);
+    cache.head = b;
+    if (++cache.count >= 2 * batch_size) {
+      // 把前batch_size块摘下来整批归还
+      block *last = cache.head;
+      for (std::size_t i = 1; i < batch_size; i++) {
+        last = last->next.load(std::memory_order_relaxed);
+      }
+      block *const batch = cache.head;
+      cache.head         = last->next.load(std::memory_order_relaxed);
+      last->next.store(nullptr, std::memory_order_relaxed);
+      cache.count -= batch_size;
+      push_batch(batch);
+    }
+  }
+
+private:
+  // 平凡类型，线程退出析构cache_flusher之后仍可安全访问
+  struct thread_cache {
+    block      *head;
+    std::size_t count;
+    bool        alive;
+  };
+
+  // 线程退出时把缓存中剩余的块整批还给全局链表
+  struct cache_flusher {
+    node_pool    &pool;
+    thread_cache &cache;
+
+    ~cache_flusher() {
+      if (cache.head) {
+        pool.push_batch(cache.head);
+      }
+      cache.head  = nullptr;
+      cache.count = 0;
+      cache.alive = false;
+    }
+  };
+
+  std::atomic<std::uint64_t> free_batches;
+  std::atomic<chunk *>       chunks;
+
+  node_pool() : free_batches(0), chunks(nullptr) {
+  }
+
+  thread_cache &local_cache() {
+    thread_local thread_cache  cache = {nullptr, 0, true};
+    thread_local cache_flusher flusher{*this, cache};
+    return cache;
+  }
+
+  static block *pointer_of(std::uint64_t packed) {
+    return reinterpret_cast<block *>(
+        static_cast<std::uintptr_t>(packed & pointer_mask));
+  }
+
+  static std::uint64_t pack(block *b, std::uint64_t old_packed) {
+    std::uint64_t const tag = (old_packed >> pointer_bits) + 1;
+    return (tag << pointer_bits) | reinterpret_cast<std::uintptr_t>(b);
+  }
+
+  void push_batch(block *batch) {
+    std::uint64_t old_packed = free_batches.load(std::memory_order_relaxed);
+    do {
+      batch->next_batch.store(pointer_of(old_packed),
+                              std::memory_order_relaxed);
+    } while (!free_batches.compare_exchange_weak(old_packed,
+                                                 pack(batch, old_packed),
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+  }
+
+  block *pop_batch() {
+    std::uint64_t old_packed = free_batches.load(std::memory_order_acquire);
+    for (;;) {
+      block *const batch = pointer_of(old_packed);
+      if (!batch) {
+        return nullptr;
+      }
+      block *const next = batch->next_batch.load(std::memory_order_relaxed);
+      if (free_batches.compare_exchange_weak(
+              old_packed, pack(next, old_packed), std::memory_order_acquire,
+              std::memory_order_acquire)) {
+        return batch;
+      }
+    }
+  }
+
+  void refill(thread_cache &cache) {
+    if (block *const batch = pop_batch()) {
+      std::size_t count = 0;
+      for (block *b = batch; b; b = b->next.load(std::memory_order_relaxed)) {
+        ++count;
+      }
+      cache.head  = batch;
+      cache.count = count;
+      return;
+    }
+    char *const memory = static_cast<char *>(
+        ::operator new(chunk_header_size + batch_size * block_size));
+    chunk *const c = reinterpret_cast<chunk *>(memory);
+    c->next        = chunks.load(std::memory_order_relaxed);
+    while (!chunks.compare_exchange_weak(c->next, c)) {
+    }
+    block *head = nullptr;
+    for (std::size_t i = batch_size; i-- > 0;) {
+      block *const b =
+          new (memory + chunk_header_size + i * block_size) block;
+      b->next.store(head, std::memory_order_relaxed);
+      b->next_batch.store(nullptr, std::memory_order_relaxed);
+      head = b;
+    }
+    cache.head  = head;
+    cache.count = batch_size;
+  }
+};
+
+// 继承pooled<Derived>后，new Derived/delete走对应大小的节点池，
+// Derived不能再被继承
+template <typename Derived>
+struct pooled {
+  static void *operator new(std::size_t size) {
+    assert(size == sizeof(Derived));
+    return node_pool<sizeof(Derived), alignof(Derived)>::instance().allocate();
+  }
+
+  static void operator delete(void *p) {
+    node_pool<sizeof(Derived), alignof(Derived)>::instance().deallocate(p);
+  }
+};
+
+// 单个对象的分配走节点池，用于std::allocate_shared
+template <typename T>
+struct pool_allocator {
+  typedef T value_type;
+
+  pool_allocator() {
+  }
+
+  template <typename U>
+  pool_allocator(pool_allocator<U> const &) {
+  }
+
+  T *allocate(std::size_t n) {
+    if (n != 1) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(
+        node_pool<sizeof(T), alignof(T)>::instance().allocate());
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    if (n != 1) {
+      ::operator delete(p);
+      return;
+    }
+    node_pool<sizeof(T), alignof(T)>::instance().deallocate(p);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(pool_allocator<T> const &, pool_allocator<U> const &) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(pool_allocator<T> const &, pool_allocator<U> const &) {
+  return false;
+}
+
+#endif  // !_NODE_POOL_H_
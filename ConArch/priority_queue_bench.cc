@@ -0,0 +1,150 @@
+/**
+ * @file priority_queue_bench.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 并发优先队列的竞争测试：mutex+std::priority_queue、multiqueue、无锁跳表
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark/alloc_counter.hpp"
+#include "multiqueue.hpp"
+#include "skiplist_priority_queue.hpp"
+
+// 对照组：一把锁保护的std::priority_queue
+template <typename T>
+class locked_priority_queue {
+public:
+  void push(T value) {
+    std::lock_guard<std::mutex> lk{mutex};
+    heap.push(std::move(value));
+  }
+
+  bool try_pop_min(T &value) {
+    std::lock_guard<std::mutex> lk{mutex};
+    if (heap.empty()) {
+      return false;
+    }
+    value = heap.top();
+    heap.pop();
+    return true;
+  }
+
+private:
+  std::mutex                                                mutex;
+  std::priority_queue<T, std::vector<T>, std::greater<T>> heap;
+};
+
+unsigned const prefill        = 10000;
+unsigned const ops_per_thread = 200000;
+
+// 每个线程交替push随机键和pop_min，队列长度大致保持在prefill附近。
+// 结束后单线程取空队列，检查取出的元素与放入的恰好相同；
+// ordered为true时取空过程中的元素必须不减
+template <typename Queue>
+bool run(std::string const &name, unsigned thread_count, bool ordered) {
+  Queue                 queue;
+  std::mt19937          prefill_random(42);
+  std::vector<unsigned> pushed;
+  for (unsigned i = 0; i < prefill; i++) {
+    pushed.push_back(prefill_random());
+    queue.push(pushed.back());
+  }
+
+  // 记录放在线程开始计数之前预留，不算进allocs/op
+  std::vector<std::vector<unsigned>> thread_pushed(thread_count);
+  std::vector<std::vector<unsigned>> thread_popped(thread_count);
+  std::vector<std::thread>           threads;
+  std::atomic<std::uint64_t>         allocations(0);
+  auto const                         start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < thread_count; t++) {
+    threads.push_back(std::thread([&, t] {
+      std::vector<unsigned> &my_pushed = thread_pushed[t];
+      std::vector<unsigned> &my_popped = thread_popped[t];
+      my_pushed.reserve(ops_per_thread / 2);
+      my_popped.reserve(ops_per_thread / 2);
+      std::mt19937        random(t);
+      unsigned            value;
+      std::uint64_t const before = thread_allocations();
+      for (unsigned i = 0; i < ops_per_thread; i++) {
+        if (i & 1) {
+          if (queue.try_pop_min(value)) {
+            my_popped.push_back(value);
+          }
+        } else {
+          value = random();
+          queue.push(value);
+          my_pushed.push_back(value);
+        }
+      }
+      allocations += thread_allocations() - before;
+    }));
+  }
+  for (unsigned t = 0; t < thread_count; t++) {
+    threads[t].join();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::vector<unsigned> popped;
+  for (unsigned t = 0; t < thread_count; t++) {
+    pushed.insert(pushed.end(), thread_pushed[t].begin(),
+                  thread_pushed[t].end());
+    popped.insert(popped.end(), thread_popped[t].begin(),
+                  thread_popped[t].end());
+  }
+  bool     in_order = true;
+  unsigned value;
+  for (std::size_t drained = 0; queue.try_pop_min(value); drained++) {
+    if (ordered && drained > 0 && value < popped.back()) {
+      in_order = false;
+    }
+    popped.push_back(value);
+  }
+  std::sort(pushed.begin(), pushed.end());
+  std::sort(popped.begin(), popped.end());
+  bool const exactly_once = pushed == popped;
+
+  std::cout << name << " threads=" << thread_count << " "
+            << thread_count * ops_per_thread / elapsed.count() << " ops/s "
+            << static_cast<double>(allocations.load()) /
+                   (thread_count * ops_per_thread)
+            << " allocs/op"
+            << (!exactly_once ? ", values lost or duplicated"
+                : !in_order   ? ", drained out of order"
+                              : ", ok")
+            << std::endl;
+  return exactly_once && in_order;
+}
+
+int main(int argc, char **argv) {
+  unsigned const max_threads =
+      argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+  bool ok = true;
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    ok = run<locked_priority_queue<unsigned>>("locked_priority_queue", threads,
+                                              true) &&
+         ok;
+    // multiqueue只是近似的最小值，不检查顺序
+    ok = run<multiqueue<unsigned>>("multiqueue", threads, false) && ok;
+    ok = run<skiplist_priority_queue<unsigned>>("skiplist_priority_queue",
+                                                threads, true) &&
+         ok;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file rcu.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 读多写少的路由表：RCU与boost::shared_mutex的读者扩展性对比
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 读者不断按下标查询路由表，一个写者每隔update_interval复制一份新表并发布。
+ * RCU版本中写者交替使用synchronize_rcu后直接释放与call_rcu延迟释放旧表；
+ * shared_mutex版本中写者持独占锁原地修改。
+ * 每张表的所有表项都等于它的版本号，读者据此检查读到的表是否完整。
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include "rcu.hpp"
+
+struct route_table {
+  std::uint64_t              version;
+  std::vector<std::uint64_t> next_hop;
+
+  explicit route_table(std::uint64_t version_)
+      : version(version_), next_hop(256, version_) {
+  }
+};
+
+class rcu_routes {
+public:
+  rcu_routes() : table(new route_table(1)) {
+  }
+
+  ~rcu_routes() {
+    rcu_barrier();
+    delete table.load();
+  }
+
+  bool lookup(unsigned key) {
+    rcu_read_guard     guard;
+    route_table *const current = rcu_dereference(table);
+    return current->next_hop[key % current->next_hop.size()] ==
+           current->version;
+  }
+
+  void update(std::uint64_t version) {
+    route_table *const old =
+        rcu_assign_pointer(table, new route_table(version));
+    if (version % 2 == 0) {
+      synchronize_rcu();
+      delete old;
+    } else {
+      call_rcu([old] {
+        delete old;
+      });
+    }
+  }
+
+private:
+  std::atomic<route_table *> table;
+};
+
+class shared_mutex_routes {
+public:
+  shared_mutex_routes() : table(1) {
+  }
+
+  bool lookup(unsigned key) {
+    boost::shared_lock<boost::shared_mutex> lock(mutex);
+    return table.next_hop[key % table.next_hop.size()] == table.version;
+  }
+
+  void update(std::uint64_t version) {
+    std::unique_lock<boost::shared_mutex> lock(mutex);
+    table.version = version;
+    for (std::size_t i = 0; i < table.next_hop.size(); i++) {
+      table.next_hop[i] = version;
+    }
+  }
+
+private:
+  boost::shared_mutex mutex;
+  route_table         table;
+};
+
+struct bench_result {
+  double        reads_per_second;
+  std::uint64_t updates;
+  bool          consistent;
+};
+
+template <typename Routes>
+bench_result run_bench(unsigned readers, std::chrono::milliseconds duration) {
+  std::chrono::microseconds const update_interval(500);
+
+  Routes                     routes;
+  std::atomic<bool>          stop(false);
+  std::atomic<std::uint64_t> reads(0);
+  std::atomic<bool>          consistent(true);
+  std::vector<std::thread>   threads;
+  for (unsigned t = 0; t < readers; t++) {
+    threads.push_back(std::thread([&routes, &stop, &reads, &consistent, t] {
+      std::uint64_t count = 0;
+      bool          ok    = true;
+      for (unsigned key = t; !stop.load(std::memory_order_relaxed); key++) {
+        ok = routes.lookup(key) && ok;
+        ++count;
+      }
+      reads += count;
+      if (!ok) {
+        consistent.store(false);
+      }
+    }));
+  }
+  std::uint64_t updates = 0;
+  auto const    start   = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < duration) {
+    routes.update(++updates + 1);
+    std::this_thread::sleep_for(update_interval);
+  }
+  stop.store(true);
+  for (std::size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  std::chrono::duration<double> const elapsed =
+      std::chrono::steady_clock::now() - start;
+  bench_result result;
+  result.reads_per_second = reads.load() / elapsed.count();
+  result.updates          = updates;
+  result.consistent       = consistent.load();
+  return result;
+}
+
+int main(int argc, char **argv) {
+  std::cout << "membarrier expedited: " << std::boolalpha
+            << default_rcu_domain().is_expedited() << std::endl;
+
+  std::chrono::milliseconds const duration(300);
+  std::printf("%-8s %16s %8s %16s %8s\n", "readers", "rcu reads/s", "updates",
+              "shared reads/s", "updates");
+  for (unsigned readers = 1; readers <= 8; readers *= 2) {
+    bench_result const rcu = run_bench<rcu_routes>(readers, duration);
+    bench_result const shared =
+        run_bench<shared_mutex_routes>(readers, duration);
+    std::printf("%-8u %16.0f %8llu %16.0f %8llu%s\n", readers,
+                rcu.reads_per_second,
+                static_cast<unsigned long long>(rcu.updates),
+                shared.reads_per_second,
+                static_cast<unsigned long long>(shared.updates),
+                rcu.consistent && shared.consistent ? "" : " inconsistent");
+  }
+}
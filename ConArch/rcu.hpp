@@ -0,0 +1,308 @@
+/**
+ * @file rcu.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 用户态RCU(URCU memb风格)：读者不做原子读改写，写者用membarrier做非对称屏障
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 读者进入临界区时把当前宽限期编号写到自己的线程记录上，离开时写0，
+ *   两次都只是普通的store，临界区内通过rcu_dereference读取共享指针；
+ * - 写者用rcu_assign_pointer发布新版本后调用synchronize：
+ *   先把宽限期编号加一，再等待所有记录编号小于新编号的读者离开临界区，
+ *   之后旧版本不再被任何读者引用；
+ * - 读者"写记录、读指针"与写者"写指针、读记录"之间需要一对全屏障，
+ *   读者一侧只放编译器屏障，由写者调用membarrier(PRIVATE_EXPEDITED)
+ *   让所有正在运行的线程执行一次全屏障来补上；
+ *   内核不支持时退化为读者自己执行seq_cst屏障；
+ * - call把回调攒成批，攒够batch_size个后由调用者等待一个宽限期再统一执行，
+ *   barrier立即执行所有已攒下的回调。
+ * synchronize、call与barrier都不能在读临界区内调用，否则会等待自己。
+ * 线程记录的认领与归还方式与epoch_domain相同，域必须比使用它的线程活得更久。
+ */
+
+#ifndef _RCU_H_
+#define _RCU_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class rcu_domain {
+public:
+  // 攒够这么多个回调就等待一个宽限期并执行
+  static std::size_t const batch_size = 64;
+
+  struct thread_record {
+    std::atomic<std::uint64_t> period;   // 0表示不在临界区，否则为进入时的宽限期
+    unsigned                   nesting;  // 仅由持有记录的线程访问
+    std::atomic<bool>          active;
+    thread_record             *next;  // 发布到链表后不再修改
+
+    thread_record() : period(0), nesting(0), active(true), next(nullptr) {
+    }
+  };
+
+  rcu_domain()
+      : expedited(register_membarrier()), grace_period(1), records(nullptr) {
+  }
+
+  rcu_domain(const rcu_domain &) = delete;
+  rcu_domain &operator=(const rcu_domain &) = delete;
+
+  ~rcu_domain() {
+    barrier();
+    thread_record *current = records.load();
+    while (current) {
+      thread_record *const next = current->next;
+      delete current;
+      current = next;
+    }
+  }
+
+  // 是否由membarrier提供读者一侧的屏障
+  bool is_expedited() const {
+    return expedited;
+  }
+
+  void read_lock(thread_record &record) {
+    if (record.nesting++ == 0) {
+      record.period.store(grace_period.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+      reader_fence();
+    }
+  }
+
+  void read_unlock(thread_record &record) {
+    if (--record.nesting == 0) {
+      // 与synchronize中的acquire读配对，临界区内的访问先于回收完成
+      record.period.store(0, std::memory_order_release);
+    }
+  }
+
+  // 等待调用前已经进入临界区的读者全部离开
+  void synchronize() {
+    std::lock_guard<std::mutex> lock(period_mutex);
+    writer_fence();
+    std::uint64_t const target =
+        grace_period.load(std::memory_order_relaxed) + 1;
+    grace_period.store(target, std::memory_order_relaxed);
+    for (thread_record *current = records.load(std::memory_order_acquire);
+         current; current = current->next) {
+      for (unsigned spins = 0;; spins++) {
+        std::uint64_t const period =
+            current->period.load(std::memory_order_acquire);
+        if (period == 0 || period >= target) {
+          break;
+        }
+        if (spins < 64) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+      }
+    }
+  }
+
+  // 在一个宽限期之后执行callback
+  void call(std::function<void()> callback) {
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(callbacks_mutex);
+      callbacks.push_back(std::move(callback));
+      if (callbacks.size() >= batch_size) {
+        ready.swap(callbacks);
+      }
+    }
+    run_after_grace_period(ready);
+  }
+
+  template <typename T>
+  void retire(T *p) {
+    call([p] {
+      delete p;
+    });
+  }
+
+  // 执行所有已提交的回调
+  void barrier() {
+    std::vector<std::function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(callbacks_mutex);
+      ready.swap(callbacks);
+    }
+    run_after_grace_period(ready);
+  }
+
+  thread_record &this_thread_record() {
+    thread_records &owned = owned_records();
+    for (std::size_t i = 0; i < owned.entries.size(); i++) {
+      if (owned.entries[i].first == this) {
+        return *owned.entries[i].second;
+      }
+    }
+    thread_record *const record = acquire_record();
+    owned.entries.push_back(std::make_pair(this, record));
+    return *record;
+  }
+
+private:
+  struct thread_records {
+    std::vector<std::pair<rcu_domain *, thread_record *>> entries;
+
+    ~thread_records() {
+      for (std::size_t i = 0; i < entries.size(); i++) {
+        entries[i].first->release_record(entries[i].second);
+      }
+    }
+  };
+
+  bool const                         expedited;
+  std::atomic<std::uint64_t>         grace_period;
+  std::atomic<thread_record *>       records;
+  std::mutex                         period_mutex;
+  std::mutex                         callbacks_mutex;
+  std::vector<std::function<void()>> callbacks;
+
+  static thread_records &owned_records() {
+    thread_local thread_records owned;
+    return owned;
+  }
+
+  static bool register_membarrier() {
+#if defined(__linux__) && defined(__NR_membarrier)
+    long const commands = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+    if (commands < 0 || !(commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED)) {
+      return false;
+    }
+    return syscall(__NR_membarrier,
+                   MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#else
+    return false;
+#endif
+  }
+
+  void reader_fence() const {
+    if (expedited) {
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+    } else {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  void writer_fence() const {
+#if defined(__linux__) && defined(__NR_membarrier)
+    if (expedited &&
+        syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0) == 0) {
+      return;
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void run_after_grace_period(std::vector<std::function<void()>> &ready) {
+    if (ready.empty()) {
+      return;
+    }
+    synchronize();
+    for (std::size_t i = 0; i < ready.size(); i++) {
+      ready[i]();
+    }
+  }
+
+  thread_record *acquire_record() {
+    for (thread_record *current = records.load(); current;
+         current = current->next) {
+      bool expected = false;
+      if (!current->active.load() &&
+          current->active.compare_exchange_strong(expected, true)) {
+        return current;
+      }
+    }
+    thread_record *const record = new thread_record;
+    record->next                = records.load();
+    while (!records.compare_exchange_weak(record->next, record)) {
+    }
+    return record;
+  }
+
+  void release_record(thread_record *record) {
+    record->nesting = 0;
+    record->period.store(0, std::memory_order_release);
+    record->active.store(false);
+  }
+};
+
+inline rcu_domain &default_rcu_domain() {
+  static rcu_domain domain;
+  return domain;
+}
+
+// 读临界区守卫：构造时进入，析构时离开，可以嵌套
+class rcu_read_guard {
+public:
+  explicit rcu_read_guard(rcu_domain &domain_ = default_rcu_domain())
+      : domain(domain_), record(domain_.this_thread_record()) {
+    domain.read_lock(record);
+  }
+
+  rcu_read_guard(rcu_read_guard const &) = delete;
+  rcu_read_guard &operator=(rcu_read_guard const &) = delete;
+
+  ~rcu_read_guard() {
+    domain.read_unlock(record);
+  }
+
+private:
+  rcu_domain                &domain;
+  rcu_domain::thread_record &record;
+};
+
+inline void rcu_read_lock() {
+  rcu_domain &domain = default_rcu_domain();
+  domain.read_lock(domain.this_thread_record());
+}
+
+inline void rcu_read_unlock() {
+  rcu_domain &domain = default_rcu_domain();
+  domain.read_unlock(domain.this_thread_record());
+}
+
+inline void synchronize_rcu() {
+  default_rcu_domain().synchronize();
+}
+
+inline void call_rcu(std::function<void()> callback) {
+  default_rcu_domain().call(std::move(callback));
+}
+
+inline void rcu_barrier() {
+  default_rcu_domain().barrier();
+}
+
+// 读临界区内读取共享指针
+template <typename T>
+T *rcu_dereference(std::atomic<T *> const &p) {
+  return p.load(std::memory_order_acquire);
+}
+
+// 发布新版本并返回旧版本，之前对*value的初始化对读者可见
+template <typename T>
+T *rcu_assign_pointer(std::atomic<T *> &p, T *value) {
+  return p.exchange(value, std::memory_order_acq_rel);
+}
+
+#endif  // !_RCU_H_
@@ -0,0 +1,81 @@
+/**
+ * @file reclaimer.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 无锁结构的内存回收策略：风险指针或EBR，作为模板参数传入
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 每个策略提供相同的接口：
+ *
+ *   typename Reclaimer::guard g;        // 在访问共享节点前构造
+ *   node *p = g.protect(head);          // 读取并保护head当前指向的节点
+ *   ...
+ *   Reclaimer::retire(p);               // 节点摘除后交给策略延迟释放
+ *
+ * hazard_pointer_reclaimer的guard占用一个风险指针，protect每次都要发布并复查；
+ * epoch_reclaimer的guard只在构造时进入一次临界区，protect就是一次acquire读取，
+ * 适合读多写少、需要遍历多个节点的结构。
+ */
+
+#ifndef _RECLAIMER_H_
+#define _RECLAIMER_H_
+
+#include <atomic>
+
+#include "epoch.hpp"
+#include "hazard_pointer.hpp"
+
+struct hazard_pointer_reclaimer {
+  class guard {
+  public:
+    guard() {
+    }
+
+    template <typename T>
+    T *protect(std::atomic<T *> const &src) {
+      return hp.protect(src);
+    }
+
+    void reset() {
+      hp.reset();
+    }
+
+  private:
+    hazard_pointer hp;
+  };
+
+  template <typename T>
+  static void retire(T *p) {
+    default_hazard_domain().retire(p);
+  }
+};
+
+struct epoch_reclaimer {
+  class guard {
+  public:
+    guard() {
+    }
+
+    // 进入临界区时的seq_cst栅栏保证这次读取不早于纪元的发布
+    template <typename T>
+    T *protect(std::atomic<T *> const &src) {
+      return src.load(std::memory_order_acquire);
+    }
+
+    // 临界区持续到guard析构
+    void reset() {
+    }
+
+  private:
+    epoch_guard critical_section;
+  };
+
+  template <typename T>
+  static void retire(T *p) {
+    default_epoch_domain().retire(p);
+  }
+};
+
+#endif  // !_RECLAIMER_H_
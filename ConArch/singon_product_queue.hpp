@@ -0,0 +1,79 @@
+/**
+ * @file singon_product_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 单生产者单消费者的无锁队列
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 尾部总有一个空的哑节点：push把数据放进哑节点并追加新的哑节点，
+ * pop在head == tail时返回空。push与pop各自只能由一个线程调用。
+ * 节点与数据都从node_pool分配。
+ */
+
+#ifndef _SINGON_PRODUCT_QUEUE_H_
+#define _SINGON_PRODUCT_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+
+#include "node_pool.hpp"
+
+template <typename T>
+class single_lock_queue {
+public:
+  single_lock_queue() : head(new node), tail(head.load()) {
+  }
+
+  single_lock_queue(single_lock_queue &) = delete;
+  single_lock_queue &operator=(const single_lock_queue &) = delete;
+
+  ~single_lock_queue() {
+    while (node *const old_head = head.load()) {
+      head.store(old_head->next);
+      delete old_head;
+    }
+  }
+
+  std::shared_ptr<T> pop() {
+    node *old_head = pop_head();
+    if (!old_head) {
+      return std::shared_ptr<T>();
+    }
+    std::shared_ptr<T> const res(old_head->data);
+    delete old_head;
+    return res;
+  }
+
+  void push(T new_value) {
+    std::shared_ptr<T> new_data =
+        std::allocate_shared<T>(pool_allocator<T>(), new_value);
+    node *      p        = new node;
+    node *const old_tail = tail.load();
+    old_tail->data.swap(new_data);
+    old_tail->next = p;
+    tail.store(p);
+  }
+
+private:
+  struct node : pooled<node> {
+    std::shared_ptr<T> data;
+    node *             next;
+    node() : next(nullptr) {
+    }
+  };
+
+  std::atomic<node *> head;
+  std::atomic<node *> tail;
+  node *              pop_head() {
+    node *const old_head = head.load();
+    if (tail.load() == old_head) {
+      return nullptr;
+    }
+    head.store(old_head->next);
+    return old_head;
+  }
+};
+
+#endif  // !_SINGON_PRODUCT_QUEUE_H_
@@ -0,0 +1,336 @@
+/**
+ * @file skiplist_priority_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 基于无锁跳表的严格优先队列
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 跳表节点的next指针最低位作为删除标记(Herlihy-Shavit无锁跳表)。
+ * pop_min沿最底层找到第一个未被认领的节点，CAS认领后自顶向下标记并摘除。
+ * 相同优先级的元素通过(线程号, 线程内序号)区分，保证跳表中键唯一。
+ * 节点回收沿用threadsafe_nomutex_stack中"操作线程计数"的做法：
+ * 最后一个离开的线程负责释放待删除链表。
+ * 节点和各层next数组(按1/2/4/8/16层取整)都从node_pool分配。
+ */
+
+#ifndef _SKIPLIST_PRIORITY_QUEUE_H_
+#define _SKIPLIST_PRIORITY_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "node_pool.hpp"
+
+template <typename T, typename Compare = std::less<T>>
+class skiplist_priority_queue {
+public:
+  static int const max_level = 16;
+
+  explicit skiplist_priority_queue(Compare const &compare_ = Compare())
+      : compare(compare_), head(max_level), threads_in_op(0),
+        to_be_deleted(nullptr) {
+  }
+
+  skiplist_priority_queue(const skiplist_priority_queue &) = delete;
+  skiplist_priority_queue &operator=(const skiplist_priority_queue &) = delete;
+
+  ~skiplist_priority_queue() {
+    node *current = get_ptr(head.next[0].load());
+    while (current) {
+      node *const next = get_ptr(current->next[0].load());
+      delete current;
+      current = next;
+    }
+    delete_nodes(to_be_deleted.load());
+  }
+
+  void push(T value) {
+    op_guard    guard(*this);
+    node *const new_node = new node(std::move(value), next_tie(),
+                                    random_level());
+    node *preds[max_level];
+    node *succs[max_level];
+    for (;;) {
+      find(*new_node, preds, succs);
+      for (int level = 0; level < new_node->levels; level++) {
+        new_node->next[level].store(make_ptr(succs[level]));
+      }
+      std::uintptr_t expected = make_ptr(succs[0]);
+      if (preds[0]->next[0].compare_exchange_strong(expected,
+                                                    make_ptr(new_node))) {
+        break;
+      }
+    }
+    for (int level = 1; level < new_node->levels; level++) {
+      for (;;) {
+        std::uintptr_t expected = make_ptr(succs[level]);
+        if (preds[level]->next[level].compare_exchange_strong(
+                expected, make_ptr(new_node))) {
+          break;
+        }
+        find(*new_node, preds, succs);
+        new_node->next[level].store(make_ptr(succs[level]));
+      }
+    }
+    // 全部层链接完成后才允许被pop_min认领，之后不再访问new_node
+    new_node->fully_linked.store(true);
+  }
+
+  bool try_pop_min(T &value) {
+    op_guard guard(*this);
+    node    *current = get_ptr(head.next[0].load());
+    while (current) {
+      if (current->fully_linked.load()) {
+        bool expected = false;
+        if (current->claimed.compare_exchange_strong(expected, true)) {
+          // 其他线程可能仍在用该节点的value做比较，这里只能拷贝
+          value = current->value;
+          remove(current);
+          return true;
+        }
+      }
+      current = get_ptr(current->next[0].load());
+    }
+    return false;
+  }
+
+  void pop_min(T &value) {
+    while (!try_pop_min(value)) {
+      std::this_thread::yield();
+    }
+  }
+
+  bool empty() {
+    op_guard guard(*this);
+    node    *current = get_ptr(head.next[0].load());
+    while (current) {
+      if (!current->claimed.load()) {
+        return false;
+      }
+      current = get_ptr(current->next[0].load());
+    }
+    return true;
+  }
+
+private:
+  typedef std::atomic<std::uintptr_t> link;
+
+  template <std::size_t Slots>
+  using tower_pool = node_pool<Slots * sizeof(link), alignof(link)>;
+
+  struct node : pooled<node> {
+    T                            value;
+    std::uint64_t                tie;
+    int                          levels;
+    link                        *next;
+    std::atomic<bool>            fully_linked;
+    std::atomic<bool>            claimed;
+    node                        *next_to_delete;
+
+    explicit node(int levels_)
+        : value(), tie(0), levels(levels_), next(new_tower(levels_)),
+          fully_linked(true), claimed(true), next_to_delete(nullptr) {
+      for (int i = 0; i < levels; i++) {
+        next[i].store(0);
+      }
+    }
+
+    node(T &&value_, std::uint64_t tie_, int levels_)
+        : value(std::move(value_)), tie(tie_), levels(levels_),
+          next(new_tower(levels_)), fully_linked(false), claimed(false),
+          next_to_delete(nullptr) {
+    }
+
+    ~node() {
+      void *const tower = next;
+      if (levels <= 1) {
+        tower_pool<1>::instance().deallocate(tower);
+      } else if (levels <= 2) {
+        tower_pool<2>::instance().deallocate(tower);
+      } else if (levels <= 4) {
+        tower_pool<4>::instance().deallocate(tower);
+      } else if (levels <= 8) {
+        tower_pool<8>::instance().deallocate(tower);
+      } else {
+        tower_pool<max_level>::instance().deallocate(tower);
+      }
+    }
+
+    static link *new_tower(int levels) {
+      void *tower;
+      if (levels <= 1) {
+        tower = tower_pool<1>::instance().allocate();
+      } else if (levels <= 2) {
+        tower = tower_pool<2>::instance().allocate();
+      } else if (levels <= 4) {
+        tower = tower_pool<4>::instance().allocate();
+      } else if (levels <= 8) {
+        tower = tower_pool<8>::instance().allocate();
+      } else {
+        tower = tower_pool<max_level>::instance().allocate();
+      }
+      link *const next = static_cast<link *>(tower);
+      for (int i = 0; i < levels; i++) {
+        new (&next[i]) link(0);
+      }
+      return next;
+    }
+  };
+
+  // 进入/离开操作时维护线程计数，离开时尝试回收
+  class op_guard {
+  public:
+    explicit op_guard(skiplist_priority_queue &queue_) : queue(queue_) {
+      ++queue.threads_in_op;
+    }
+    ~op_guard() {
+      queue.try_reclaim();
+    }
+
+  private:
+    skiplist_priority_queue &queue;
+  };
+
+  Compare               compare;
+  node                  head;
+  std::atomic<unsigned> threads_in_op;
+  std::atomic<node *>   to_be_deleted;
+
+  static node *get_ptr(std::uintptr_t p) {
+    return reinterpret_cast<node *>(p & ~std::uintptr_t(1));
+  }
+
+  static bool is_marked(std::uintptr_t p) {
+    return p & 1;
+  }
+
+  static std::uintptr_t make_ptr(node *p, bool marked = false) {
+    return reinterpret_cast<std::uintptr_t>(p) | (marked ? 1 : 0);
+  }
+
+  bool less(node const &lhs, node const &rhs) const {
+    if (compare(lhs.value, rhs.value)) {
+      return true;
+    }
+    if (compare(rhs.value, lhs.value)) {
+      return false;
+    }
+    return lhs.tie < rhs.tie;
+  }
+
+  // 定位每一层上key的前驱和后继，顺带摘除沿途已标记的节点
+  void find(node const &key, node **preds, node **succs) {
+  retry:
+    node *pred = &head;
+    for (int level = max_level - 1; level >= 0; level--) {
+      node *current = get_ptr(pred->next[level].load());
+      while (current) {
+        std::uintptr_t succ = current->next[level].load();
+        while (is_marked(succ)) {
+          std::uintptr_t expected = make_ptr(current);
+          if (!pred->next[level].compare_exchange_strong(
+                  expected, make_ptr(get_ptr(succ)))) {
+            goto retry;
+          }
+          current = get_ptr(succ);
+          if (!current) {
+            break;
+          }
+          succ = current->next[level].load();
+        }
+        if (current && less(*current, key)) {
+          pred    = current;
+          current = get_ptr(succ);
+        } else {
+          break;
+        }
+      }
+      preds[level] = pred;
+      succs[level] = current;
+    }
+  }
+
+  // 已被当前线程认领的节点：自顶向下打删除标记，再通过find完成物理摘除
+  void remove(node *victim) {
+    for (int level = victim->levels - 1; level >= 0; level--) {
+      std::uintptr_t succ = victim->next[level].load();
+      while (!is_marked(succ)) {
+        victim->next[level].compare_exchange_weak(succ, succ | 1);
+      }
+    }
+    node *preds[max_level];
+    node *succs[max_level];
+    find(*victim, preds, succs);
+    chain_pending_node(victim);
+  }
+
+  void try_reclaim() {
+    if (threads_in_op == 1) {
+      node *nodes_to_delete = to_be_deleted.exchange(nullptr);
+      if (!--threads_in_op) {
+        delete_nodes(nodes_to_delete);
+      } else if (nodes_to_delete) {
+        chain_pending_nodes(nodes_to_delete);
+      }
+    } else {
+      --threads_in_op;
+    }
+  }
+
+  static void delete_nodes(node *nodes) {
+    while (nodes) {
+      node *next = nodes->next_to_delete;
+      delete nodes;
+      nodes = next;
+    }
+  }
+
+  void chain_pending_nodes(node *nodes) {
+    node *last = nodes;
+    while (node *const next = last->next_to_delete) {
+      last = next;
+    }
+    last->next_to_delete = to_be_deleted.load();
+    while (!to_be_deleted.compare_exchange_weak(last->next_to_delete, nodes)) {
+    }
+  }
+
+  void chain_pending_node(node *n) {
+    n->next_to_delete = nullptr;
+    chain_pending_nodes(n);
+  }
+
+  static std::uint32_t random() {
+    static std::atomic<std::uint32_t> seed(0);
+    thread_local std::uint32_t state = 2463534242u + seed.fetch_add(1);
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  static int random_level() {
+    std::uint32_t bits  = random();
+    int           level = 1;
+    while ((bits & 1) && level < max_level) {
+      ++level;
+      bits >>= 1;
+    }
+    return level;
+  }
+
+  // 高24位为线程号，低40位为线程内序号
+  static std::uint64_t next_tie() {
+    static std::atomic<std::uint64_t> next_thread(0);
+    thread_local std::uint64_t const  thread_bits = next_thread.fetch_add(1)
+                                                   << 40;
+    thread_local std::uint64_t        counter     = 0;
+    return thread_bits | counter++;
+  }
+};
+
+#endif  // !_SKIPLIST_PRIORITY_QUEUE_H_
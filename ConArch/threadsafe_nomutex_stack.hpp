@@ -0,0 +1,110 @@
+/**
+ * @file threadsafe_nomutex_stack.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 无锁的线程安全栈，统计pop中的线程数回收节点
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 只有一个线程在pop中时才删除节点，否则挂到待删除链表上，
+ * 由最后一个离开pop的线程统一删除；pop竞争激烈时待删除链表可能一直增长。
+ */
+
+#ifndef _THREADSAFE_NOMUTEX_STACK_H_
+#define _THREADSAFE_NOMUTEX_STACK_H_
+
+#include <atomic>
+#include <memory>
+
+template <typename T>
+class lock_free_stack {
+public:
+  lock_free_stack() : head(nullptr), threads_in_pop(0), to_be_deleted(nullptr) {
+  }
+
+  lock_free_stack(const lock_free_stack &) = delete;
+  lock_free_stack &operator=(const lock_free_stack &) = delete;
+
+  ~lock_free_stack() {
+    delete_nodes(head.load());
+    delete_nodes(to_be_deleted.load());
+  }
+
+  void push(T const &data) {
+    node *const new_node = new node(data);
+    new_node->next       = head.load();
+    while (!head.compare_exchange_weak(new_node->next, new_node)) {
+    }
+  }
+
+  std::shared_ptr<T> pop() {
+    ++threads_in_pop;  // 计数器增加1
+    node *old_head = head.load();
+    while (old_head && !head.compare_exchange_weak(old_head, old_head->next)) {
+    }
+    std::shared_ptr<T> res;
+    if (old_head) {
+      res.swap(old_head->data);
+    }
+    try_reclaim(old_head);
+    return res;
+  }
+
+private:
+  struct node {
+    std::shared_ptr<T> data;
+    node              *next;
+    node(T const &value) : data(std::make_shared<T>(value)), next(nullptr) {
+    }
+  };
+
+  std::atomic<node *>   head;
+  std::atomic<unsigned> threads_in_pop;
+  std::atomic<node *>   to_be_deleted;  // 计划删除list
+
+  static void delete_nodes(node *nodes) {
+    while (nodes) {
+      node *next = nodes->next;
+      delete nodes;
+      nodes = next;
+    }
+  }
+
+  void try_reclaim(node *old_head) {
+    if (1 == threads_in_pop) {
+      node *nodes_to_delete = to_be_deleted.exchange(nullptr);
+      if (!--threads_in_pop) {
+        delete_nodes(nodes_to_delete);
+      } else if (nodes_to_delete) {
+        chain_pending_nodes(nodes_to_delete);
+      }
+      delete old_head;
+    } else {
+      if (old_head) {
+        chain_pending_node(old_head);  // 只挂这一个节点，不能沿next挂上栈中节点
+      }
+      --threads_in_pop;
+    }
+  }
+
+  void chain_pending_nodes(node *nodes) {
+    node *last = nodes;
+    while (node *const next = last->next) {
+      last = next;
+    }
+    chain_pending_nodes(nodes, last);
+  }
+
+  void chain_pending_nodes(node *first, node *last) {
+    last->next = to_be_deleted;
+    while (!to_be_deleted.compare_exchange_weak(last->next, first)) {
+    }
+  }
+
+  void chain_pending_node(node *n) {
+    chain_pending_nodes(n, n);
+  }
+};
+
+#endif  // !_THREADSAFE_NOMUTEX_STACK_H_
@@ -19,68 +19,7 @@
 #include <functional>
 #include <algorithm>
 
-template <typename T> class thread_safe_queue {
-public:
-  thread_safe_queue() {}
-
-  thread_safe_queue(thread_safe_queue const &other) {
-    std::lock_guard<std::mutex> lk{_mutex};
-    _data = other._data;
-  }
-
-  void push(T &value) {
-    std::lock_guard<std::mutex> lk{_mutex};
-    _data.push(value);
-    _conn_var.notify_one();
-  }
-
-  void wait_and_pop(T &value) {
-    std::unique_lock<std::mutex> uk{_mutex};
-    _conn_var.wait(uk, [this] { return !_data.empty(); });
-    value = _data.front();
-    _data.pop();
-  }
-
-  std::shared_ptr<T> pop() {
-    std::unique_lock<std::mutex> uk{_mutex};
-    _conn_var.wait(uk, [this] { return !_data.empty(); });
-    std::shared_ptr<T> res = std::make_shared<T>(_data.front());
-    _data.pop();
-    return res;
-  }
-
-  bool try_pop(T &value) {
-    std::lock_guard<std::mutex> lk{_mutex};
-    if (_data.empty()) {
-      return false;
-    }
-    value = _data.front();
-    _data.pop();
-
-    return true;
-  }
-
-  std::shared_ptr<T> try_pop() {
-    std::lock_guard<std::mutex> lk{_mutex};
-    if (_data.empty()) {
-      return nullptr;
-    }
-    std::shared_ptr<T> res = std::make_shared<T>(_data.front());
-    _data.pop();
-
-    return res;
-  }
-
-  bool empty() const {
-    std::lock_guard<std::mutex> lk{_mutex};
-    return _data.empty();
-  }
-
-private:
-  mutable std::mutex _mutex;
-  std::queue<T> _data;
-  std::condition_variable _conn_var;
-};
+#include "thread_safe_queue.hpp"
 
 int main(int argc, char **argv) {
   std::shared_ptr<thread_safe_queue<int>> safe_queue =
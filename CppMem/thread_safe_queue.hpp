@@ -0,0 +1,83 @@
+/**
+ * @file thread_safe_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 线程安全队列
+ * @version 0.1
+ * @date 2020-06-21
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+
+#ifndef _CPPMEM_THREAD_SAFE_QUEUE_H_
+#define _CPPMEM_THREAD_SAFE_QUEUE_H_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+template <typename T> class thread_safe_queue {
+public:
+  thread_safe_queue() {}
+
+  thread_safe_queue(thread_safe_queue const &other) {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _data = other._data;
+  }
+
+  void push(T &value) {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _data.push(value);
+    _conn_var.notify_one();
+  }
+
+  void wait_and_pop(T &value) {
+    std::unique_lock<std::mutex> uk{_mutex};
+    _conn_var.wait(uk, [this] { return !_data.empty(); });
+    value = _data.front();
+    _data.pop();
+  }
+
+  std::shared_ptr<T> pop() {
+    std::unique_lock<std::mutex> uk{_mutex};
+    _conn_var.wait(uk, [this] { return !_data.empty(); });
+    std::shared_ptr<T> res = std::make_shared<T>(_data.front());
+    _data.pop();
+    return res;
+  }
+
+  bool try_pop(T &value) {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_data.empty()) {
+      return false;
+    }
+    value = _data.front();
+    _data.pop();
+
+    return true;
+  }
+
+  std::shared_ptr<T> try_pop() {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_data.empty()) {
+      return nullptr;
+    }
+    std::shared_ptr<T> res = std::make_shared<T>(_data.front());
+    _data.pop();
+
+    return res;
+  }
+
+  bool empty() const {
+    std::lock_guard<std::mutex> lk{_mutex};
+    return _data.empty();
+  }
+
+private:
+  mutable std::mutex _mutex;
+  std::queue<T> _data;
+  std::condition_variable _conn_var;
+};
+
+#endif  // !_CPPMEM_THREAD_SAFE_QUEUE_H_
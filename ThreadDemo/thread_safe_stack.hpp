@@ -0,0 +1,98 @@
+/**
+ * @file thread_safe_stack.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 线程安全的栈，一把互斥锁保护std::stack
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _THREAD_SAFE_STACK_H_
+#define _THREAD_SAFE_STACK_H_
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stack>
+#include <thread>
+
+struct empty_stack : std::exception {
+  const char *what() const throw() {
+    return "empty stack";
+  }
+};
+
+template <typename T>
+class thread_safe_stack {
+public:
+  using shared_ptr = std::shared_ptr<T>;
+
+  explicit thread_safe_stack() : _stack(std::stack<T>()) {}
+
+  thread_safe_stack(const thread_safe_stack &other) {
+    std::lock_guard<std::mutex> lk{other._mutex};
+    _stack = other._stack;
+  }
+
+  thread_safe_stack &operator=(const thread_safe_stack &) = delete;
+
+  void push(T const &value) {
+    std::lock_guard<std::mutex> lk{_mutex};
+    _stack.push(value);
+  }
+
+  void pop(T &value) {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_stack.empty()) {
+      throw empty_stack();
+    }
+    value = _stack.top();
+    _stack.pop();
+  }
+
+  // 栈为空时返回false，不抛异常
+  bool try_pop(T &value) {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_stack.empty()) {
+      return false;
+    }
+    value = _stack.top();
+    _stack.pop();
+    return true;
+  }
+
+  void pop_void() {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_stack.empty()) {
+      throw empty_stack();
+    }
+
+    std::cout << "This Thread is " << std::this_thread::get_id()
+              << " get value is " << _stack.top() << std::endl;
+    _stack.pop();
+  }
+
+  shared_ptr pop() {
+    std::lock_guard<std::mutex> lk{_mutex};
+    if (_stack.empty()) {
+      throw empty_stack();
+    }
+    shared_ptr const res = std::make_shared<T>(_stack.top());
+    _stack.pop();
+    return res;
+  }
+
+  bool is_empty() {
+    std::lock_guard<std::mutex> lk{_mutex};
+    return _stack.empty();
+  }
+
+private:
+  std::stack<T>      _stack;
+  mutable std::mutex _mutex;
+};
+
+#endif  // !_THREAD_SAFE_STACK_H_
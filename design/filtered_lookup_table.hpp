@@ -0,0 +1,178 @@
+/**
+ * @file filtered_lookup_table.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 前置布隆过滤器的查找表：未命中的查找只读一条缓存行就返回
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 在threadsafe_lookup_table前放一个blocked_bloom_filter，接口与查找表相同：
+ * - 查找先问过滤器，一定不存在时直接返回默认值，不碰桶与分段锁；
+ * - 写入先写表再把哈希插入过滤器，所以过滤器中没有的键表中一定没有；
+ * - 删除只写表，过滤器中的旧位保留，误判率随删除变高。删除次数超过
+ *   过滤器容量的一半，或者元素数超过其容量时，由触发的写线程重建：
+ *   先发布空的next，再遍历表的快照把键插入next，最后替换当前过滤器，
+ *   旧过滤器交给epoch回收；
+ * - 重建期间的写线程同时插入当前过滤器与next，插入后若当前过滤器已被替换，
+ *   对新的过滤器再插一次。快照之后的写入都能看到已发布的next，
+ *   所以新过滤器不会漏掉任何键。
+ * 同一时刻只有一个线程重建，其余线程不等待，继续使用当前过滤器。
+ */
+
+#ifndef _FILTERED_LOOKUP_TABLE_H_
+#define _FILTERED_LOOKUP_TABLE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "ConArch/epoch.hpp"
+#include "blocked_bloom_filter.hpp"
+#include "threadsafe_lookup_table.hpp"
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class filtered_lookup_table {
+public:
+  typedef Key   key_type;
+  typedef Value mapped_type;
+  typedef Hash  hash_type;
+
+  static std::size_t const min_filter_keys = 1024;
+
+  explicit filtered_lookup_table(unsigned    num_buckets = 19,
+                                 Hash const &hasher_     = Hash())
+      : table(num_buckets, hasher_),
+        filter(new blocked_bloom_filter(min_filter_keys)),
+        next(nullptr),
+        filter_keys(min_filter_keys),
+        removals(0),
+        hasher(hasher_) {
+  }
+
+  filtered_lookup_table(const filtered_lookup_table &) = delete;
+  filtered_lookup_table &operator=(const filtered_lookup_table &) = delete;
+
+  ~filtered_lookup_table() {
+    delete filter.load();
+  }
+
+  Value value_for(Key const &key, Value const &default_value = Value()) const {
+    if (!may_contain(key)) {
+      return default_value;
+    }
+    return table.value_for(key, default_value);
+  }
+
+  // 找到时以const Value&调用f，返回是否找到
+  template <typename Function>
+  bool visit(Key const &key, Function f) const {
+    return may_contain(key) && table.visit(key, f);
+  }
+
+  void add_or_update_mapping(Key const &key, Value const &value) {
+    table.add_or_update_mapping(key, value);
+    remember(hasher(key));
+    maybe_rebuild();
+  }
+
+  void remove_mapping(Key const &key) {
+    if (!may_contain(key)) {
+      return;
+    }
+    table.remove_mapping(key);
+    ++removals;
+    maybe_rebuild();
+  }
+
+  // 按表的当前内容重建过滤器，另一个线程正在重建时等它完成后再建一次
+  void rebuild_filter() {
+    std::lock_guard<std::mutex> lk{rebuild_mutex};
+    rebuild_locked();
+  }
+
+  std::map<Key, Value> get_map() const {
+    return table.get_map();
+  }
+
+  std::size_t size() const {
+    return table.size();
+  }
+
+  std::size_t bucket_count() const {
+    return table.bucket_count();
+  }
+
+  // 当前过滤器按多少个键分配的空间
+  std::size_t filter_capacity() const {
+    return filter_keys.load(std::memory_order_relaxed);
+  }
+
+private:
+  threadsafe_lookup_table<Key, Value, Hash> table;
+  std::atomic<blocked_bloom_filter *>       filter;
+  std::atomic<blocked_bloom_filter *>       next;  // 正在重建的过滤器
+  std::atomic<std::size_t>                  filter_keys;
+  std::atomic<std::size_t>                  removals;  // 上次重建以来
+  std::mutex                                rebuild_mutex;
+  Hash                                      hasher;
+
+  bool may_contain(Key const &key) const {
+    std::size_t const hash = hasher(key);
+    epoch_guard       guard;
+    return filter.load()->may_contain(hash);
+  }
+
+  void remember(std::size_t hash) {
+    epoch_guard guard;
+    for (;;) {
+      blocked_bloom_filter *const current = filter.load();
+      current->insert(hash);
+      if (blocked_bloom_filter *const pending = next.load()) {
+        pending->insert(hash);
+      }
+      if (filter.load() == current) {
+        return;
+      }
+    }
+  }
+
+  void maybe_rebuild() {
+    if (!needs_rebuild()) {
+      return;
+    }
+    std::unique_lock<std::mutex> lk{rebuild_mutex, std::try_to_lock};
+    if (lk.owns_lock() && needs_rebuild()) {
+      rebuild_locked();
+    }
+  }
+
+  bool needs_rebuild() const {
+    std::size_t const keys = filter_keys.load(std::memory_order_relaxed);
+    return table.size() > keys ||
+           removals.load(std::memory_order_relaxed) > keys / 2;
+  }
+
+  // 新过滤器按当前元素数的两倍分配，之后插入的键也有余量
+  void rebuild_locked() {
+    std::size_t const keys =
+        std::max(2 * table.size(), std::size_t(min_filter_keys));
+    std::unique_ptr<blocked_bloom_filter> fresh(new blocked_bloom_filter(keys));
+    removals.store(0);
+    next.store(fresh.get());
+    table.take_snapshot().for_each(
+        [this, &fresh](Key const &key, Value const &) {
+          fresh->insert(hasher(key));
+        });
+    blocked_bloom_filter *const old = filter.exchange(fresh.release());
+    next.store(nullptr);
+    filter_keys.store(keys);
+    default_epoch_domain().retire(old);
+  }
+};
+
+#endif  // !_FILTERED_LOOKUP_TABLE_H_
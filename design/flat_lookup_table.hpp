@@ -0,0 +1,333 @@
+/**
+ * @file flat_lookup_table.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 分片的开放寻址查找表，每个槽位1字节标签，SSE2一次比较16个
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 与threadsafe_lookup_table接口相同，存储方式不同：
+ * - 哈希值经过混合后，若干位选分片，低7位作为标签，其余位选起始组；
+ * - 每个分片一把boost::shared_mutex，内部是开放寻址表，容量为16的倍数，
+ *   标签、键、值分别放在三段连续数组中；
+ * - 标签：0x80为空，0xFE为已删除，其余为哈希的低7位(最高位为0)。
+ *   查找按组(16个槽位)二次探测，SSE2一条比较得到本组所有标签相同的槽位，
+ *   只对这些槽位比较键，组内有空槽就停止；
+ * - 删除时若所在组还有空槽，任何探测都会停在本组，直接置为空，
+ *   否则留下删除标记；有效元素加删除标记超过容量的7/8时整理或扩容该分片。
+ * 不支持SSE2的平台逐字节比较，结果相同。
+ */
+
+#ifndef _FLAT_LOOKUP_TABLE_H_
+#define _FLAT_LOOKUP_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include "hash_mix.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class flat_lookup_table {
+public:
+  typedef Key   key_type;
+  typedef Value mapped_type;
+  typedef Hash  hash_type;
+
+  static unsigned const default_shards = 64;
+
+  explicit flat_lookup_table(unsigned    num_slots  = 19,
+                             Hash const &hasher_    = Hash(),
+                             unsigned    num_shards = default_shards)
+      : shard_bits(bits_for(num_shards)),
+        shards(new shard[std::size_t(1) << shard_bits]),
+        hasher(hasher_) {
+    std::size_t const per_shard = (num_slots >> shard_bits) + 1;
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      shards[i].reserve(per_shard, hasher);
+    }
+  }
+
+  flat_lookup_table(const flat_lookup_table &) = delete;
+  flat_lookup_table &operator=(const flat_lookup_table &) = delete;
+
+  Value value_for(Key const &key, Value const &default_value = Value()) const {
+    std::size_t const                       hash = hash_mix(hasher(key));
+    shard const                            &s    = shard_for(hash);
+    boost::shared_lock<boost::shared_mutex> lk{s.mutex};
+    std::size_t const                       slot = s.find(hash, key);
+    return slot == npos ? default_value : s.values()[slot];
+  }
+
+  void add_or_update_mapping(Key const &key, Value const &value) {
+    std::size_t const                     hash = hash_mix(hasher(key));
+    shard                                &s    = shard_for(hash);
+    std::unique_lock<boost::shared_mutex> lk{s.mutex};
+    std::size_t const                     slot = s.find(hash, key);
+    if (slot != npos) {
+      s.values()[slot] = value;
+    } else {
+      s.insert(hash, key, value, hasher);
+    }
+  }
+
+  void remove_mapping(Key const &key) {
+    std::size_t const                     hash = hash_mix(hasher(key));
+    shard                                &s    = shard_for(hash);
+    std::unique_lock<boost::shared_mutex> lk{s.mutex};
+    std::size_t const                     slot = s.find(hash, key);
+    if (slot != npos) {
+      s.erase(slot);
+    }
+  }
+
+  std::map<Key, Value> get_map() const {
+    std::map<Key, Value> res;
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      boost::shared_lock<boost::shared_mutex> lk{shards[i].mutex};
+      shards[i].copy_to(res);
+    }
+    return res;
+  }
+
+  std::size_t size() const {
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      boost::shared_lock<boost::shared_mutex> lk{shards[i].mutex};
+      res += shards[i].size;
+    }
+    return res;
+  }
+
+private:
+  static std::size_t const  npos        = std::size_t(-1);
+  static std::size_t const  group_width = 16;
+  static std::uint8_t const empty       = 0x80;
+  static std::uint8_t const deleted     = 0xFE;
+
+  typedef typename std::aligned_storage<sizeof(Key), alignof(Key)>::type
+      key_storage;
+  typedef typename std::aligned_storage<sizeof(Value), alignof(Value)>::type
+      value_storage;
+
+  // 组内标签匹配的位图，第i位对应组内第i个槽位
+  static unsigned match_tag(std::uint8_t const *group, std::uint8_t tag) {
+#if defined(__SSE2__)
+    __m128i const tags =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(group));
+    return static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+    unsigned res = 0;
+    for (std::size_t i = 0; i < group_width; i++) {
+      res |= unsigned(group[i] == tag) << i;
+    }
+    return res;
+#endif
+  }
+
+  // 空槽与删除标记的最高位为1，有效标签最高位为0
+  static unsigned match_free(std::uint8_t const *group) {
+#if defined(__SSE2__)
+    return static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(group))));
+#else
+    unsigned res = 0;
+    for (std::size_t i = 0; i < group_width; i++) {
+      res |= unsigned(group[i] >> 7) << i;
+    }
+    return res;
+#endif
+  }
+
+  static unsigned lowest_bit(unsigned mask) {
+    return static_cast<unsigned>(__builtin_ctz(mask));
+  }
+
+  struct shard {
+    mutable boost::shared_mutex      mutex;
+    std::unique_ptr<std::uint8_t[]>  tags;
+    std::unique_ptr<key_storage[]>   key_slots;
+    std::unique_ptr<value_storage[]> value_slots;
+    std::size_t                      groups;
+    std::size_t                      size;
+    std::size_t                      tombstones;
+    char                             padding[64];
+
+    shard() : groups(0), size(0), tombstones(0) {
+    }
+
+    ~shard() {
+      clear_slots();
+    }
+
+    Key *keys() const {
+      return reinterpret_cast<Key *>(key_slots.get());
+    }
+
+    Value *values() const {
+      return reinterpret_cast<Value *>(value_slots.get());
+    }
+
+    std::size_t capacity() const {
+      return groups * group_width;
+    }
+
+    void reserve(std::size_t slots, Hash const &hasher) {
+      std::size_t wanted = 1;
+      while (wanted * group_width * 7 / 8 < slots) {
+        wanted <<= 1;
+      }
+      if (wanted > groups) {
+        rehash(wanted, hasher);
+      }
+    }
+
+    std::size_t find(std::size_t hash, Key const &key) const {
+      std::uint8_t const tag  = static_cast<std::uint8_t>(hash & 0x7F);
+      std::size_t const  mask = groups - 1;
+      std::size_t        g    = (hash >> 7) & mask;
+      for (std::size_t step = 1; step <= groups; step++) {
+        std::uint8_t const *const group = &tags[g * group_width];
+        for (unsigned m = match_tag(group, tag); m; m &= m - 1) {
+          std::size_t const slot = g * group_width + lowest_bit(m);
+          if (keys()[slot] == key) {
+            return slot;
+          }
+        }
+        if (match_tag(group, empty)) {
+          return npos;
+        }
+        g = (g + step) & mask;
+      }
+      return npos;
+    }
+
+    // 调用者已确认key不存在
+    void insert(std::size_t hash, Key const &key, Value const &value,
+                Hash const &hasher) {
+      if ((size + tombstones + 1) * 8 > capacity() * 7) {
+        // 删除标记占多数时原容量整理即可
+        rehash(size * 2 >= capacity() * 7 / 8 ? groups * 2 : groups, hasher);
+      }
+      std::size_t const slot = free_slot(hash);
+      if (tags[slot] == deleted) {
+        --tombstones;
+      }
+      new (&keys()[slot]) Key(key);
+      new (&values()[slot]) Value(value);
+      tags[slot] = static_cast<std::uint8_t>(hash & 0x7F);
+      ++size;
+    }
+
+    void erase(std::size_t slot) {
+      keys()[slot].~Key();
+      values()[slot].~Value();
+      std::uint8_t const *const group =
+          &tags[slot / group_width * group_width];
+      if (match_tag(group, empty)) {
+        tags[slot] = empty;
+      } else {
+        tags[slot] = deleted;
+        ++tombstones;
+      }
+      --size;
+    }
+
+    void copy_to(std::map<Key, Value> &res) const {
+      for (std::size_t slot = 0; slot < capacity(); slot++) {
+        if (!(tags[slot] & 0x80)) {
+          res.insert(std::make_pair(keys()[slot], values()[slot]));
+        }
+      }
+    }
+
+  private:
+    // 探测序列上第一个空槽或删除标记
+    std::size_t free_slot(std::size_t hash) const {
+      std::size_t const mask = groups - 1;
+      std::size_t       g    = (hash >> 7) & mask;
+      for (std::size_t step = 1;; step++) {
+        unsigned const m = match_free(&tags[g * group_width]);
+        if (m) {
+          return g * group_width + lowest_bit(m);
+        }
+        g = (g + step) & mask;
+      }
+    }
+
+    // 新数组全部分配成功后才替换，分配失败时分片保持原样
+    void rehash(std::size_t new_groups, Hash const &hasher) {
+      std::size_t const                new_capacity = new_groups * group_width;
+      std::unique_ptr<std::uint8_t[]>  new_tags(new std::uint8_t[new_capacity]);
+      std::unique_ptr<key_storage[]>   new_keys(new key_storage[new_capacity]);
+      std::unique_ptr<value_storage[]> new_values(
+          new value_storage[new_capacity]);
+      std::memset(new_tags.get(), empty, new_capacity);
+
+      std::unique_ptr<std::uint8_t[]>  old_tags(std::move(tags));
+      std::unique_ptr<key_storage[]>   old_keys(std::move(key_slots));
+      std::unique_ptr<value_storage[]> old_values(std::move(value_slots));
+      std::size_t const                old_capacity = capacity();
+
+      tags        = std::move(new_tags);
+      key_slots   = std::move(new_keys);
+      value_slots = std::move(new_values);
+      groups      = new_groups;
+      tombstones  = 0;
+
+      Key *const   from_keys   = reinterpret_cast<Key *>(old_keys.get());
+      Value *const from_values = reinterpret_cast<Value *>(old_values.get());
+      for (std::size_t slot = 0; slot < old_capacity; slot++) {
+        if (old_tags[slot] & 0x80) {
+          continue;
+        }
+        std::size_t const to = free_slot(hash_mix(hasher(from_keys[slot])));
+        new (&keys()[to]) Key(std::move(from_keys[slot]));
+        new (&values()[to]) Value(std::move(from_values[slot]));
+        tags[to] = old_tags[slot];
+        from_keys[slot].~Key();
+        from_values[slot].~Value();
+      }
+    }
+
+    void clear_slots() {
+      for (std::size_t slot = 0; slot < capacity(); slot++) {
+        if (!(tags[slot] & 0x80)) {
+          keys()[slot].~Key();
+          values()[slot].~Value();
+        }
+      }
+    }
+  };
+
+  unsigned const                 shard_bits;
+  std::unique_ptr<shard[]> const shards;
+  Hash                           hasher;
+
+  std::size_t shard_count() const {
+    return std::size_t(1) << shard_bits;
+  }
+
+  // 分片用最高几位，标签与起始组用低位，互不相关
+  shard &shard_for(std::size_t hash) const {
+    return shard_bits ? shards[hash >> (sizeof(std::size_t) * 8 - shard_bits)]
+                      : shards[0];
+  }
+};
+
+#endif  // !_FLAT_LOOKUP_TABLE_H_
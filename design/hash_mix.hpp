@@ -0,0 +1,37 @@
+/**
+ * @file hash_mix.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 查找表、缓存与过滤器共用的哈希混合与位数计算
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _HASH_MIX_H_
+#define _HASH_MIX_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// murmur3的64位收尾混合，std::hash对整数是恒等映射
+inline std::uint64_t hash_mix(std::uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// 使(1 << bits) >= n的最小bits
+inline unsigned bits_for(std::size_t n) {
+  unsigned bits = 0;
+  while (bits < sizeof(std::size_t) * 8 - 1 && (std::size_t(1) << bits) < n) {
+    bits++;
+  }
+  return bits;
+}
+
+#endif  // !_HASH_MIX_H_
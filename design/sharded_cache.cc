@@ -0,0 +1,119 @@
+/**
+ * @file sharded_cache.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief sharded_cache的演示：容量上限、过期与偏斜负载下的命中率
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sharded_cache.hpp"
+
+// 按字节计费：键值的长度之和
+struct string_weigher {
+  std::size_t operator()(unsigned const &, std::string const &value) const {
+    return sizeof(unsigned) + value.size();
+  }
+};
+
+int main(int argc, char **argv) {
+  bool ok = true;
+
+  // 过期：写入后立即可读，超过ttl后按未命中处理
+  {
+    sharded_cache<unsigned, unsigned> cache(64, 4);
+    cache.put(1, 10, std::chrono::milliseconds(20));
+    cache.put(2, 20);
+    unsigned value = 0;
+    ok             = cache.get(1, value) && value == 10 && ok;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    ok = !cache.get(1, value) && cache.get(2, value) && value == 20 && ok;
+    ok = cache.stats().expirations == 1 && cache.size() == 1 && ok;
+    std::cout << "ttl " << (ok ? "ok" : "failed") << std::endl;
+  }
+
+  // 容量小于分片数：分片数随之减少，条目数不超过容量
+  {
+    unsigned const sizes[] = {1, 4, 10, 17};
+    for (unsigned capacity : sizes) {
+      sharded_cache<unsigned, unsigned> cache(capacity, 16);
+      for (unsigned key = 0; key < 1000; key++) {
+        cache.put(key, key);
+      }
+      ok = cache.size() == capacity && ok;
+    }
+    try {
+      sharded_cache<unsigned, unsigned> empty(0);
+      ok = false;
+    } catch (std::invalid_argument const &) {
+    }
+    std::cout << "small capacity " << (ok ? "ok" : "failed") << std::endl;
+  }
+
+  // 按字节计的容量：占用始终不超过上限
+  {
+    std::size_t const capacity = 64 * 1024;
+    sharded_cache<unsigned, std::string, std::hash<unsigned>, string_weigher>
+        cache(capacity, 8);
+    for (unsigned key = 0; key < 10000; key++) {
+      cache.put(key, std::string(key % 200 + 1, 'x'));
+      ok = cache.charge() <= capacity && ok;
+    }
+    std::cout << "bytes " << cache.charge() << "/" << capacity << ", "
+              << cache.size() << " entries, " << cache.stats().evictions
+              << " evictions" << (ok ? ", ok" : ", over capacity")
+              << std::endl;
+  }
+
+  // 偏斜负载：多数访问落在少量热键上，未命中时"回源"并写入
+  {
+    unsigned const                    threads  = 4;
+    unsigned const                    ops      = 200000;
+    unsigned const                    keys     = 100000;
+    std::size_t const                 capacity = 10000;
+    sharded_cache<unsigned, unsigned> cache(capacity);
+    std::vector<std::thread>          workers;
+    auto const start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; t++) {
+      workers.push_back(std::thread([&cache, t, ops, keys] {
+        std::mt19937                            random(t);
+        std::uniform_int_distribution<unsigned> hot(0, keys / 100 - 1);
+        std::uniform_int_distribution<unsigned> any(0, keys - 1);
+        for (unsigned i = 0; i < ops; i++) {
+          unsigned const key   = i % 10 < 9 ? hot(random) : any(random);
+          unsigned       value = 0;
+          if (!cache.get(key, value)) {
+            cache.put(key, key * 3);
+          } else if (value != key * 3) {
+            std::cout << "wrong value for " << key << std::endl;
+          }
+        }
+      }));
+    }
+    for (std::size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+    std::chrono::duration<double> const elapsed =
+        std::chrono::steady_clock::now() - start;
+    cache_stats const stats = cache.stats();
+    ok = stats.hits + stats.misses == threads * ops &&
+         cache.size() <= capacity && ok;
+    std::cout << "skewed: hit ratio "
+              << double(stats.hits) / (stats.hits + stats.misses) << ", "
+              << stats.evictions << " evictions, "
+              << threads * ops / elapsed.count() << " ops/s"
+              << (ok ? ", ok" : ", failed") << std::endl;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,323 @@
+/**
+ * @file sharded_cache.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 分片的并发缓存：容量上限 + CLOCK淘汰 + 惰性过期
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 按键的哈希分成若干分片，每个分片一把boost::shared_mutex，
+ *   内部是键到槽位的索引和一圈槽位(CLOCK的环)；
+ * - 命中只持读锁：查索引、检查过期时间、把槽位的访问位置一(已为一时不写)，
+ *   不移动任何链表节点；
+ * - 插入持写锁，超出分片容量时转动指针：访问位为一的清零放过，
+ *   为零的或已过期的淘汰，最多转两圈一定能腾出空间；
+ * - 容量的单位由Weigher决定，默认每个条目计1，即条目数上限；
+ *   传入返回字节数的Weigher即为字节上限；
+ * - 过期时间只在访问时检查，过期条目在命中路径上按未命中处理，
+ *   随后持写锁删除，或者等指针转到时回收。
+ */
+
+#ifndef _SHARDED_CACHE_H_
+#define _SHARDED_CACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include "hash_mix.hpp"
+
+// 每个条目计1，容量即条目数
+struct unit_weigher {
+  template <typename Key, typename Value>
+  std::size_t operator()(Key const &, Value const &) const {
+    return 1;
+  }
+};
+
+struct cache_stats {
+  std::uint64_t hits;
+  std::uint64_t misses;
+  std::uint64_t evictions;
+  std::uint64_t expirations;
+};
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Weigher = unit_weigher>
+class sharded_cache {
+public:
+  typedef Key   key_type;
+  typedef Value mapped_type;
+
+  static unsigned const default_shards = 16;
+
+  explicit sharded_cache(std::size_t    capacity_,
+                         unsigned       num_shards = default_shards,
+                         Hash const    &hasher_    = Hash(),
+                         Weigher const &weigher_   = Weigher())
+      : shard_bits(shard_bits_for(num_shards, capacity_)),
+        shards(new shard[std::size_t(1) << shard_bits]),
+        capacity(capacity_),
+        hasher(hasher_),
+        weigher(weigher_) {
+    // 余数分给前几个分片，各分片容量之和恰好等于capacity
+    std::size_t const per_shard = capacity >> shard_bits;
+    std::size_t const remainder = capacity & (shard_count() - 1);
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      shards[i].capacity = per_shard + (i < remainder ? 1 : 0);
+      shards[i].index    = index_type(0, hasher);
+    }
+  }
+
+  sharded_cache(const sharded_cache &) = delete;
+  sharded_cache &operator=(const sharded_cache &) = delete;
+
+  // 命中时把值复制到value并返回true
+  bool get(Key const &key, Value &value) {
+    shard &s       = shard_for(key);
+    bool   expired = false;
+    {
+      boost::shared_lock<boost::shared_mutex> lk{s.mutex};
+      auto const found = s.index.find(key);
+      if (found != s.index.end()) {
+        entry &e = s.slots[found->second];
+        if (e.expires && e.expires <= now_ns()) {
+          expired = true;
+        } else {
+          if (!e.referenced.load(std::memory_order_relaxed)) {
+            e.referenced.store(true, std::memory_order_relaxed);
+          }
+          value = e.value;
+          s.hits.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+    }
+    s.misses.fetch_add(1, std::memory_order_relaxed);
+    if (expired) {
+      std::unique_lock<boost::shared_mutex> lk{s.mutex};
+      auto const found = s.index.find(key);
+      if (found != s.index.end()) {
+        entry const &e = s.slots[found->second];
+        if (e.expires && e.expires <= now_ns()) {
+          s.expirations.fetch_add(1, std::memory_order_relaxed);
+          s.release(found->second, found);
+        }
+      }
+    }
+    return false;
+  }
+
+  // ttl为零表示不过期。单个条目超过分片容量时不缓存，返回false
+  bool put(Key const &key, Value const &value,
+           std::chrono::milliseconds ttl = std::chrono::milliseconds(0)) {
+    std::size_t const charge = weigher(key, value);
+    shard            &s      = shard_for(key);
+    if (charge > s.capacity) {
+      return false;
+    }
+    std::int64_t const expires =
+        ttl.count() > 0 ? now_ns() + ttl.count() * 1000000 : 0;
+
+    std::unique_lock<boost::shared_mutex> lk{s.mutex};
+    std::size_t                           slot;
+    auto const                            found = s.index.find(key);
+    if (found != s.index.end()) {
+      slot     = found->second;
+      entry &e = s.slots[slot];
+      s.used  -= e.charge;
+      e.value  = value;
+    } else {
+      slot = s.acquire(key, value);
+      s.index.insert(std::make_pair(key, slot));
+    }
+    entry &e  = s.slots[slot];
+    e.charge  = charge;
+    e.expires = expires;
+    e.referenced.store(false, std::memory_order_relaxed);
+    s.used += charge;
+    s.evict(slot);
+    return true;
+  }
+
+  void erase(Key const &key) {
+    shard                                &s = shard_for(key);
+    std::unique_lock<boost::shared_mutex> lk{s.mutex};
+    auto const                            found = s.index.find(key);
+    if (found != s.index.end()) {
+      s.release(found->second, found);
+    }
+  }
+
+  cache_stats stats() const {
+    cache_stats res = {0, 0, 0, 0};
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      res.hits        += shards[i].hits.load(std::memory_order_relaxed);
+      res.misses      += shards[i].misses.load(std::memory_order_relaxed);
+      res.evictions   += shards[i].evictions.load(std::memory_order_relaxed);
+      res.expirations +=
+          shards[i].expirations.load(std::memory_order_relaxed);
+    }
+    return res;
+  }
+
+  // 当前条目数
+  std::size_t size() const {
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      boost::shared_lock<boost::shared_mutex> lk{shards[i].mutex};
+      res += shards[i].index.size();
+    }
+    return res;
+  }
+
+  // 当前占用的容量(Weigher的单位)
+  std::size_t charge() const {
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < shard_count(); i++) {
+      boost::shared_lock<boost::shared_mutex> lk{shards[i].mutex};
+      res += shards[i].used;
+    }
+    return res;
+  }
+
+private:
+  struct entry {
+    Key               key;
+    Value             value;
+    std::size_t       charge;
+    std::int64_t      expires;  // steady_clock纳秒，0表示不过期
+    bool              occupied;
+    std::atomic<bool> referenced;  // 持读锁时也可写，其余成员由写锁保护
+
+    entry(Key const &key_, Value const &value_)
+        : key(key_),
+          value(value_),
+          charge(0),
+          expires(0),
+          occupied(true),
+          referenced(false) {
+    }
+  };
+
+  typedef std::unordered_map<Key, std::size_t, Hash> index_type;
+
+  struct shard {
+    mutable boost::shared_mutex mutex;
+    index_type                  index;
+    std::deque<entry>           slots;  // 追加时不移动已有槽位
+    std::vector<std::size_t>    free_slots;
+    std::size_t                 hand;
+    std::size_t                 used;
+    std::size_t                 capacity;
+    std::atomic<std::uint64_t>  hits;
+    std::atomic<std::uint64_t>  misses;
+    std::atomic<std::uint64_t>  evictions;
+    std::atomic<std::uint64_t>  expirations;
+    char                        padding[64];
+
+    shard()
+        : hand(0),
+          used(0),
+          capacity(1),
+          hits(0),
+          misses(0),
+          evictions(0),
+          expirations(0) {
+    }
+
+    std::size_t acquire(Key const &key, Value const &value) {
+      if (free_slots.empty()) {
+        slots.emplace_back(key, value);
+        return slots.size() - 1;
+      }
+      std::size_t const slot = free_slots.back();
+      free_slots.pop_back();
+      entry &e   = slots[slot];
+      e.key      = key;
+      e.value    = value;
+      e.occupied = true;
+      return slot;
+    }
+
+    void release(std::size_t slot, typename index_type::iterator found) {
+      entry &e = slots[slot];
+      index.erase(found);
+      used       -= e.charge;
+      e.occupied  = false;
+      e.value     = Value();
+      free_slots.push_back(slot);
+    }
+
+    // 转动指针直到容量够用，keep是刚写入的槽位，除非只剩它否则不淘汰
+    void evict(std::size_t keep) {
+      std::int64_t const now = used > capacity ? now_ns() : 0;
+      for (std::size_t steps = 0; used > capacity && steps < 2 * slots.size();
+           steps++) {
+        std::size_t const slot = hand;
+        hand                   = (hand + 1) % slots.size();
+        entry &e               = slots[slot];
+        if (!e.occupied || slot == keep) {
+          continue;
+        }
+        if (e.expires && e.expires <= now) {
+          expirations.fetch_add(1, std::memory_order_relaxed);
+        } else if (e.referenced.load(std::memory_order_relaxed)) {
+          e.referenced.store(false, std::memory_order_relaxed);
+          continue;
+        } else {
+          evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        release(slot, index.find(e.key));
+      }
+    }
+  };
+
+  unsigned const                 shard_bits;
+  std::unique_ptr<shard[]> const shards;
+  std::size_t const              capacity;
+  Hash                           hasher;
+  Weigher                        weigher;
+
+  // 分片数向上取2的幂，但不超过容量，保证每个分片至少能放一个单位
+  static unsigned shard_bits_for(unsigned num_shards, std::size_t capacity) {
+    if (capacity == 0) {
+      throw std::invalid_argument("sharded_cache: capacity must be positive");
+    }
+    unsigned bits = bits_for(num_shards);
+    while (bits > 0 && (std::size_t(1) << bits) > capacity) {
+      bits--;
+    }
+    return bits;
+  }
+
+  static std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  std::size_t shard_count() const {
+    return std::size_t(1) << shard_bits;
+  }
+
+  // 乘法散列取高位，std::hash对整数是恒等映射
+  shard &shard_for(Key const &key) const {
+    std::uint64_t const h =
+        static_cast<std::uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ULL;
+    return shard_bits ? shards[h >> (64 - shard_bits)] : shards[0];
+  }
+};
+
+#endif  // !_SHARDED_CACHE_H_
@@ -0,0 +1,134 @@
+/**
+ * @file spill_queue.cc
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 消费者落后时队列溢出到磁盘，消费者追上后按序读回
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "spill_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+struct record {
+  std::uint64_t seq;
+  char          payload[120];
+};
+
+// 溢出目录不存在：换段失败的push抛出异常，之前的记录仍可按序读出
+bool check_spill_failure() {
+  spill_queue<record> queue("/nonexistent-spill-dir", 8, 4);
+  std::uint64_t       pushed = 0;
+  unsigned            failed = 0;
+  record              r;
+  for (std::uint64_t i = 0; i < 32; i++) {
+    r.seq = pushed;
+    try {
+      queue.push(r);
+      ++pushed;
+    } catch (std::runtime_error const &) {
+      ++failed;
+    }
+  }
+  bool ok = failed == 32 - pushed && pushed > 0;
+  for (std::uint64_t i = 0; i < pushed; i++) {
+    ok = queue.try_pop(r) && r.seq == i && ok;
+  }
+  ok = !queue.try_pop(r) && ok;
+  try {
+    spill_queue<record> empty_segments("/tmp", 8, 0);
+    ok = false;
+  } catch (std::invalid_argument const &) {
+  }
+  std::cout << "spill failure: " << pushed << " pushed, " << failed
+            << " rejected, " << (ok ? "ok" : "broken") << std::endl;
+  return ok;
+}
+
+// 消费者先阻塞在wait_and_pop上，生产者随后开始逐个push；
+// 通知丢失时消费者会一直等下去，超时即判为失败
+bool check_blocked_consumer() {
+  std::uint64_t const        total = 200000;
+  spill_queue<record>        queue("/tmp", 1024, 256);
+  std::atomic<std::uint64_t> consumed(0);
+  bool                       in_order = true;
+  std::thread                consumer{[&queue, &consumed, &in_order, total] {
+    record r;
+    for (std::uint64_t i = 0; i < total; i++) {
+      queue.wait_and_pop(r);
+      in_order = r.seq == i && in_order;
+      consumed.store(i + 1);
+    }
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread producer{[&queue, total] {
+    record r;
+    for (std::uint64_t i = 0; i < total; i++) {
+      r.seq = i;
+      queue.push(r);
+      if (i % 64 == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }};
+  producer.join();
+  auto const deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (consumed.load() < total &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  if (consumed.load() < total) {
+    std::cout << "blocked consumer: stuck after " << consumed.load()
+              << " records, broken" << std::endl;
+    std::_Exit(1);
+  }
+  consumer.join();
+  std::cout << "blocked consumer: " << total << " records, "
+            << (in_order ? "ok" : "order broken") << std::endl;
+  return in_order;
+}
+
+int main(int argc, char **argv) {
+  if (!check_spill_failure() || !check_blocked_consumer()) {
+    return 1;
+  }
+  std::string const   dir   = argc > 1 ? argv[1] : "/tmp";
+  std::uint64_t const total = 1000000;
+
+  // 内存中最多保留约64K条记录，其余溢出到dir下的段文件
+  spill_queue<record> queue(dir, 64 * 1024, 8192);
+
+  std::thread producer{[&queue, total] {
+    record r;
+    for (std::uint64_t i = 0; i < total; i++) {
+      r.seq = i;
+      queue.push(r);
+    }
+  }};
+
+  // 消费者先停顿一段时间，模拟处理落后
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  std::cout << "spilled segments: " << queue.spilled() << std::endl;
+
+  bool   in_order = true;
+  record r;
+  for (std::uint64_t i = 0; i < total; i++) {
+    queue.wait_and_pop(r);
+    if (r.seq != i) {
+      in_order = false;
+    }
+  }
+  producer.join();
+  std::cout << (in_order ? "all records in order" : "order broken")
+            << ", spilled segments left: " << queue.spilled() << std::endl;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file spill_queue.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 超过内存阈值后溢出到mmap段文件的分段队列
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 与threadsafe_queue一样用head/tail两把锁保护一个链表，区别是链表的
+ * 每个节点是一段可容纳segment_items个元素的连续存储：
+ *  - 内存中的段数未超过阈值时，新段分配在堆上；
+ *  - 超过阈值后，新段是目录下只追加写的文件，通过mmap顺序写入和读取，
+ *    文件在打开后立即unlink，段读完munmap即释放磁盘空间。
+ * 元素始终按段链表的顺序出队，因此溢出前后整体保持FIFO。
+ * 元素按字节拷贝进段中，T必须是平凡可拷贝类型。
+ */
+
+#ifndef _SPILL_QUEUE_H_
+#define _SPILL_QUEUE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+template <typename T>
+class spill_queue {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "spill_queue stores elements as raw bytes");
+
+public:
+  // memory_threshold: 允许驻留内存的元素数上限(按段取整)
+  spill_queue(std::string const &spill_dir_,
+              std::size_t        memory_threshold,
+              std::size_t        segment_items_ = 4096)
+      : spill_dir(spill_dir_), segment_items(segment_items_),
+        max_memory_segments(std::max<std::size_t>(
+            1, memory_threshold / std::max<std::size_t>(1, segment_items_))),
+        memory_segments(0), spilled_segments(0), next_segment_id(0) {
+    if (segment_items == 0) {
+      throw std::invalid_argument("spill_queue segment_items must be positive");
+    }
+    head.reset(new_segment());
+    tail = head.get();
+  }
+
+  spill_queue(const spill_queue &) = delete;
+  spill_queue &operator=(const spill_queue &) = delete;
+
+  // 新段分配失败(如溢出目录不存在)时抛出异常，队列保持原样
+  void push(T const &value) {
+    {
+      std::lock_guard<std::mutex> tail_lock{tail_mutex};
+      std::size_t const           index = tail->write_index.load();
+      // 写入最后一个位置之前先备好下一段
+      std::unique_ptr<segment> new_tail;
+      if (index + 1 == segment_items) {
+        new_tail.reset(new_segment());
+      }
+      std::memcpy(tail->data + index * sizeof(T), &value, sizeof(T));
+      tail->write_index.store(index + 1);
+      if (new_tail) {
+        // 当前段写满，先封存再挂上新段
+        tail->seal();
+        tail->next = std::move(new_tail);
+        tail       = tail->next.get();
+      }
+    }
+    // 消费者检查条件到开始等待期间一直持有head_mutex，先取一次head_mutex
+    // 保证它要么已经在等待，要么之后检查时能看到新元素，通知不会丢失
+    {
+      std::lock_guard<std::mutex> head_lock{head_mutex};
+    }
+    data_con.notify_one();
+  }
+
+  bool try_pop(T &value) {
+    std::lock_guard<std::mutex> head_lock{head_mutex};
+    return pop_locked(value);
+  }
+
+  void wait_and_pop(T &value) {
+    std::unique_lock<std::mutex> head_lock{head_mutex};
+    data_con.wait(head_lock, [&] {
+      return pop_locked(value);
+    });
+  }
+
+  bool empty() {
+    std::lock_guard<std::mutex> head_lock{head_mutex};
+    return head->read_index == head->write_index.load() &&
+           head.get() == get_tail();
+  }
+
+  // 当前仍在磁盘上的段数，便于观察是否发生了溢出
+  std::size_t spilled() const {
+    return spilled_segments.load();
+  }
+
+private:
+  struct segment {
+    char                    *data;
+    std::size_t              bytes;
+    bool                     mapped;
+    std::size_t              read_index;  // 仅在head_mutex下访问
+    std::atomic<std::size_t> write_index;
+    std::unique_ptr<segment> next;
+
+    segment(char *data_, std::size_t bytes_, bool mapped_)
+        : data(data_), bytes(bytes_), mapped(mapped_), read_index(0),
+          write_index(0) {
+    }
+
+    ~segment() {
+      if (mapped) {
+        munmap(data, bytes);
+      } else {
+        delete[] data;
+      }
+    }
+
+    // 写满的文件段异步刷盘，让内核尽早回写脏页
+    void seal() {
+      if (mapped) {
+        msync(data, bytes, MS_ASYNC);
+      }
+    }
+  };
+
+  std::string const        spill_dir;
+  std::size_t const        segment_items;
+  std::size_t const        max_memory_segments;
+  std::atomic<std::size_t> memory_segments;
+  std::atomic<std::size_t> spilled_segments;
+  std::size_t              next_segment_id;  // 仅在tail_mutex下访问
+  std::mutex               head_mutex;
+  std::unique_ptr<segment> head;
+  std::mutex               tail_mutex;
+  segment                 *tail;
+  std::condition_variable  data_con;
+
+  segment *get_tail() {
+    std::lock_guard<std::mutex> tail_lock{tail_mutex};
+    return tail;
+  }
+
+  bool pop_locked(T &value) {
+    if (head->read_index == head->write_index.load()) {
+      // 当前段已读完：只有生产者已经换到下一段时才能丢弃它
+      if (head->read_index != segment_items || head.get() == get_tail()) {
+        return false;
+      }
+      drop_head();
+      if (head->read_index == head->write_index.load()) {
+        return false;
+      }
+    }
+    std::memcpy(&value, head->data + head->read_index * sizeof(T), sizeof(T));
+    ++head->read_index;
+    return true;
+  }
+
+  void drop_head() {
+    std::unique_ptr<segment> const old_head = std::move(head);
+    head                                    = std::move(old_head->next);
+    if (old_head->mapped) {
+      spilled_segments.fetch_sub(1);
+    } else {
+      memory_segments.fetch_sub(1);
+    }
+  }
+
+  segment *new_segment() {
+    std::size_t const bytes = segment_items * sizeof(T);
+    if (memory_segments.load() < max_memory_segments) {
+      std::unique_ptr<char[]> data(new char[bytes]);
+      segment *const          res = new segment(data.get(), bytes, false);
+      data.release();
+      memory_segments.fetch_add(1);
+      return res;
+    }
+    std::string const path = spill_dir + "/spill-" +
+                             std::to_string(next_segment_id++) + ".seg";
+    int const fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+      throw std::runtime_error("open " + path + ": " + std::strerror(errno));
+    }
+    // 打开后即可删除目录项，段释放时磁盘空间随munmap一起回收
+    unlink(path.c_str());
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      int const err = errno;
+      close(fd);
+      throw std::runtime_error("ftruncate " + path + ": " +
+                               std::strerror(err));
+    }
+    void *const p =
+        mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int const err = errno;
+    close(fd);
+    if (p == MAP_FAILED) {
+      throw std::runtime_error("mmap " + path + ": " + std::strerror(err));
+    }
+    madvise(p, bytes, MADV_SEQUENTIAL);
+    segment *res;
+    try {
+      res = new segment(static_cast<char *>(p), bytes, true);
+    } catch (...) {
+      munmap(p, bytes);
+      throw;
+    }
+    spilled_segments.fetch_add(1);
+    return res;
+  }
+};
+
+#endif  // !_SPILL_QUEUE_H_
@@ -0,0 +1,419 @@
+/**
+ * @file split_ordered_table.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 无锁查找表：Shalev-Shavit的split-ordered list，扩容不加锁也不搬动元素
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * 与threadsafe_lookup_table接口相同，写操作不加任何锁：
+ * - 全部元素串在一条按"反转后的哈希"排序的无锁链表(Harris-Michael)上，
+ *   桶只是指向链表中哨兵节点的捷径。桶b的哨兵键为reverse(b)，
+ *   元素的键为reverse(hash | 最高位)，所以哨兵为偶数、元素为奇数，
+ *   桶b的元素恰好排在哨兵b与下一个哨兵之间；
+ * - 桶数为2的幂，平均每桶元素数超过max_load时用一次CAS把桶数翻倍。
+ *   桶b翻倍后拆成b与b + 旧桶数，新桶第一次被访问时才把哨兵插入链表，
+ *   插入位置从父桶(去掉最高位)的哨兵开始找，元素本身不动；
+ * - 桶目录按段分配：段0为桶[0, 2)，段k为桶[2^k, 2^(k + 1))，
+ *   段第一次用到时用CAS发布，之后不再移动，直到析构才释放；
+ * - 删除先在节点的next上打标记(最低位)，再从前驱摘除，
+ *   沿途遇到已标记的节点顺手摘除，摘除成功的线程把节点交给风险指针域回收；
+ * - 值放在不可变的value_box里，更新时整个换掉，旧的交给风险指针域回收。
+ *   读者持有节点的风险指针期间节点不会被释放，节点释放时才删除它当前的值。
+ *
+ * 查找占用3个风险指针(前驱、当前节点、值)，哨兵节点永不删除，无需保护。
+ * 更新与删除同时作用于同一个键时，更新可能落在刚被删除的节点上，
+ * 相当于更新先于删除发生。
+ */
+
+#ifndef _SPLIT_ORDERED_TABLE_H_
+#define _SPLIT_ORDERED_TABLE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "ConArch/hazard_pointer.hpp"
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class split_ordered_table {
+public:
+  typedef Key   key_type;
+  typedef Value mapped_type;
+  typedef Hash  hash_type;
+
+  static unsigned const max_load        = 2;
+  static unsigned const max_bucket_bits = 32;
+
+  explicit split_ordered_table(unsigned num_buckets = 2,
+                               Hash const &hasher_ = Hash())
+      : head(new node(0)),
+        bucket_size(round_up_power_of_two(num_buckets)),
+        count(0),
+        hasher(hasher_) {
+    for (unsigned i = 0; i < max_bucket_bits; i++) {
+      segments[i].store(nullptr);
+    }
+    bucket_slot(0)->store(head);
+  }
+
+  split_ordered_table(const split_ordered_table &) = delete;
+  split_ordered_table &operator=(const split_ordered_table &) = delete;
+
+  // 已摘除的节点由风险指针域在之后释放
+  ~split_ordered_table() {
+    node *current = head;
+    while (current) {
+      node *const next = get_ptr(current->next.load());
+      if (is_entry(current)) {
+        delete static_cast<entry *>(current);
+      } else {
+        delete current;
+      }
+      current = next;
+    }
+    for (unsigned i = 0; i < max_bucket_bits; i++) {
+      delete[] segments[i].load();
+    }
+  }
+
+  Value value_for(Key const &key, Value const &default_value = Value()) const {
+    std::size_t const hash   = hasher(key);
+    node *const       bucket = bucket_for(hash);
+    position          pos;
+    if (!find(bucket, regular_key(hash), key_matches(key), pos)) {
+      return default_value;
+    }
+    hazard_pointer value_guard;
+    return value_guard.protect(static_cast<entry *>(pos.cur)->value)->value;
+  }
+
+  void add_or_update_mapping(Key const &key, Value const &value) {
+    std::size_t const          hash   = hasher(key);
+    std::uint64_t const        so_key = regular_key(hash);
+    node *const                bucket = bucket_for(hash);
+    std::unique_ptr<value_box> box(new value_box(value));
+    std::unique_ptr<entry>     fresh;
+    position                   pos;
+    for (;;) {
+      if (find(bucket, so_key, key_matches(key), pos)) {
+        value_box *const replacement =
+            fresh ? fresh->value.exchange(nullptr) : box.release();
+        default_hazard_domain().retire(
+            static_cast<entry *>(pos.cur)->value.exchange(replacement));
+        return;
+      }
+      if (!fresh) {
+        fresh.reset(new entry(so_key, key, box.release()));
+      }
+      std::uintptr_t expected = make_ptr(pos.cur);
+      fresh->next.store(expected);
+      if (pos.prev->compare_exchange_strong(expected, make_ptr(fresh.get()))) {
+        fresh.release();
+        break;
+      }
+    }
+    grow(++count);
+  }
+
+  void remove_mapping(Key const &key) {
+    std::size_t const   hash   = hasher(key);
+    std::uint64_t const so_key = regular_key(hash);
+    node *const         bucket = bucket_for(hash);
+    position            pos;
+    for (;;) {
+      if (!find(bucket, so_key, key_matches(key), pos)) {
+        return;
+      }
+      // 打上标记的线程负责计数，摘除可以由任何线程完成
+      std::uintptr_t next = pos.next;
+      if (!pos.cur->next.compare_exchange_strong(next, next | 1)) {
+        continue;
+      }
+      --count;
+      std::uintptr_t expected = make_ptr(pos.cur);
+      if (pos.prev->compare_exchange_strong(expected, next)) {
+        default_hazard_domain().retire(static_cast<entry *>(pos.cur));
+      } else {
+        find(bucket, so_key, key_matches(key), pos);
+      }
+      return;
+    }
+  }
+
+  // 逐个节点读取，不是原子快照
+  std::map<Key, Value> get_map() const {
+    std::map<Key, Value> res;
+    hazard_pointer       prev_guard;
+    hazard_pointer       cur_guard;
+    hazard_pointer       value_guard;
+  retry:
+    std::atomic<std::uintptr_t> *prev = &head->next;
+    node                        *cur  = get_ptr(prev->load());
+    prev_guard.reset();
+    while (cur) {
+      cur_guard.set(cur);
+      if (prev->load() != make_ptr(cur)) {
+        goto retry;
+      }
+      std::uintptr_t const next = cur->next.load();
+      if (is_marked(next)) {
+        if (!unlink(prev, cur, next)) {
+          goto retry;
+        }
+        cur = get_ptr(next);
+        continue;
+      }
+      if (is_entry(cur)) {
+        entry *const e = static_cast<entry *>(cur);
+        res[e->key]    = value_guard.protect(e->value)->value;
+      }
+      prev = &cur->next;
+      prev_guard.set(cur);
+      cur = get_ptr(next);
+    }
+    return res;
+  }
+
+  std::size_t size() const {
+    std::ptrdiff_t const n = count.load();
+    return n > 0 ? static_cast<std::size_t>(n) : 0;
+  }
+
+  std::size_t bucket_count() const {
+    return bucket_size.load();
+  }
+
+private:
+  struct node {
+    std::uint64_t const         so_key;
+    std::atomic<std::uintptr_t> next;  // 最低位为删除标记
+
+    explicit node(std::uint64_t so_key_) : so_key(so_key_), next(0) {
+    }
+  };
+
+  struct value_box {
+    Value const value;
+
+    explicit value_box(Value const &value_) : value(value_) {
+    }
+  };
+
+  struct entry : node {
+    Key const                key;
+    std::atomic<value_box *> value;
+
+    entry(std::uint64_t so_key_, Key const &key_, value_box *value_)
+        : node(so_key_), key(key_), value(value_) {
+    }
+
+    ~entry() {
+      delete value.load();
+    }
+  };
+
+  // find的结果：cur为第一个不小于目标的节点，prev为指向它的next
+  struct position {
+    hazard_pointer               prev_guard;
+    hazard_pointer               cur_guard;
+    std::atomic<std::uintptr_t> *prev;
+    node                        *cur;
+    std::uintptr_t               next;  // 找到时cur->next的值(无标记)
+  };
+
+  class key_matches {
+  public:
+    explicit key_matches(Key const &key_) : key(key_) {
+    }
+
+    bool operator()(node const *n) const {
+      return static_cast<entry const *>(n)->key == key;
+    }
+
+  private:
+    Key const &key;
+  };
+
+  // 哨兵的反转键唯一，键相同即为同一个哨兵
+  struct any_node {
+    bool operator()(node const *) const {
+      return true;
+    }
+  };
+
+  static std::size_t const max_buckets = std::size_t(1) << max_bucket_bits;
+
+  typedef std::atomic<node *> *segment;
+
+  node *const                  head;
+  mutable std::atomic<segment> segments[max_bucket_bits];
+  std::atomic<std::size_t>     bucket_size;
+  std::atomic<std::ptrdiff_t>  count;
+  Hash                         hasher;
+
+  static std::size_t round_up_power_of_two(std::size_t n) {
+    std::size_t res = 2;
+    while (res < n && res < max_buckets) {
+      res <<= 1;
+    }
+    return res;
+  }
+
+  static unsigned highest_bit(std::size_t n) {
+    return 63 - __builtin_clzll(static_cast<unsigned long long>(n));
+  }
+
+  static std::uint64_t reverse_bits(std::uint64_t x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+    x = ((x >> 16) & 0x0000FFFF0000FFFFULL) |
+        ((x & 0x0000FFFF0000FFFFULL) << 16);
+    return (x >> 32) | (x << 32);
+  }
+
+  static std::uint64_t regular_key(std::size_t hash) {
+    return reverse_bits(static_cast<std::uint64_t>(hash) | (1ULL << 63));
+  }
+
+  static std::uint64_t dummy_key(std::size_t bucket) {
+    return reverse_bits(bucket);
+  }
+
+  static bool is_entry(node const *n) {
+    return n->so_key & 1;
+  }
+
+  static node *get_ptr(std::uintptr_t p) {
+    return reinterpret_cast<node *>(p & ~std::uintptr_t(1));
+  }
+
+  static bool is_marked(std::uintptr_t p) {
+    return p & 1;
+  }
+
+  static std::uintptr_t make_ptr(node *p) {
+    return reinterpret_cast<std::uintptr_t>(p);
+  }
+
+  void grow(std::ptrdiff_t items) {
+    std::size_t size = bucket_size.load();
+    if (items > static_cast<std::ptrdiff_t>(size * max_load) &&
+        size < max_buckets) {
+      bucket_size.compare_exchange_strong(size, size * 2);
+    }
+  }
+
+  // 桶目录中桶b的位置，所在段尚未分配时分配并用CAS发布
+  std::atomic<node *> *bucket_slot(std::size_t b) const {
+    unsigned const    index = b < 2 ? 0 : highest_bit(b);
+    std::size_t const base  = index ? std::size_t(1) << index : 0;
+    segment           slots = segments[index].load();
+    if (!slots) {
+      std::size_t const                      length = index ? base : 2;
+      std::unique_ptr<std::atomic<node *>[]> fresh(
+          new std::atomic<node *>[length]);
+      for (std::size_t i = 0; i < length; i++) {
+        fresh[i].store(nullptr, std::memory_order_relaxed);
+      }
+      if (segments[index].compare_exchange_strong(slots, fresh.get())) {
+        slots = fresh.release();
+      }
+    }
+    return &slots[b - base];
+  }
+
+  node *bucket_for(std::size_t hash) const {
+    return bucket_node(hash & (bucket_size.load() - 1));
+  }
+
+  node *bucket_node(std::size_t b) const {
+    node *const dummy = bucket_slot(b)->load();
+    return dummy ? dummy : initialize_bucket(b);
+  }
+
+  // 从父桶的哨兵开始把桶b的哨兵插入链表，已被别的线程插入时用现成的
+  node *initialize_bucket(std::size_t b) const {
+    std::size_t const     parent = b & ~(std::size_t(1) << highest_bit(b));
+    std::uint64_t const   so_key = dummy_key(b);
+    node *const           start  = bucket_node(parent);
+    std::unique_ptr<node> fresh(new node(so_key));
+    node                 *dummy;
+    {
+      position pos;
+      for (;;) {
+        if (find(start, so_key, any_node(), pos)) {
+          dummy = pos.cur;
+          break;
+        }
+        std::uintptr_t expected = make_ptr(pos.cur);
+        fresh->next.store(expected);
+        if (pos.prev->compare_exchange_strong(expected,
+                                              make_ptr(fresh.get()))) {
+          dummy = fresh.release();
+          break;
+        }
+      }
+    }
+    node *expected = nullptr;
+    bucket_slot(b)->compare_exchange_strong(expected, dummy);
+    return dummy;
+  }
+
+  // 把已标记的cur从prev后摘除，成功的线程负责回收
+  static bool unlink(std::atomic<std::uintptr_t> *prev, node *cur,
+                     std::uintptr_t next) {
+    std::uintptr_t expected = make_ptr(cur);
+    if (!prev->compare_exchange_strong(expected, next & ~std::uintptr_t(1))) {
+      return false;
+    }
+    default_hazard_domain().retire(static_cast<entry *>(cur));
+    return true;
+  }
+
+  // 从哨兵start开始找反转键为so_key且matches的节点，沿途摘除已标记的节点。
+  // cur在读next之前由风险指针保护，并确认prev仍指向它(prev所在节点
+  // 被标记时prev的值带标记位，比较同样失败)
+  template <typename Matches>
+  static bool find(node *start, std::uint64_t so_key, Matches matches,
+                   position &pos) {
+  retry:
+    pos.prev = &start->next;
+    pos.cur  = get_ptr(pos.prev->load());
+    pos.prev_guard.reset();
+    while (pos.cur) {
+      pos.cur_guard.set(pos.cur);
+      if (pos.prev->load() != make_ptr(pos.cur)) {
+        goto retry;
+      }
+      std::uintptr_t const next = pos.cur->next.load();
+      if (is_marked(next)) {
+        if (!unlink(pos.prev, pos.cur, next)) {
+          goto retry;
+        }
+        pos.cur = get_ptr(next);
+        continue;
+      }
+      if (pos.cur->so_key > so_key) {
+        return false;
+      }
+      if (pos.cur->so_key == so_key && matches(pos.cur)) {
+        pos.next = next;
+        return true;
+      }
+      pos.prev = &pos.cur->next;
+      pos.prev_guard.set(pos.cur);
+      pos.cur = get_ptr(next);
+    }
+    return false;
+  }
+};
+
+#endif  // !_SPLIT_ORDERED_TABLE_H_
@@ -0,0 +1,820 @@
+/**
+ * @file threadsafe_lookup_table.hpp
+ * @author koritafei (koritafei@gmail.com)
+ * @brief 线程安全的查找表：锁分段 + 自动扩容 + 渐进式rehash + 无锁读
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * - 桶数为2的幂，每个桶是一条单链表，节点中保存完整哈希值，迁移时不必重算；
+ * - 锁与桶分开：固定数量(2的幂)的分段锁，桶b由分段b & (分段数 - 1)保护。
+ *   桶数不小于分段数，扩容时桶b拆成b与b + 旧桶数，两者仍属于同一分段；
+ * - 元素数超过桶数时扩容：锁住全部分段，发布两倍大小的新桶数组，
+ *   旧数组挂在新数组的previous上，之后每次写操作结束后
+ *   顺带迁移migrate_batch个旧桶，没有哪一次操作需要搬完整张表；
+ * - 迁移期间旧桶已搬完的用moved()标记，查找先看旧桶，已搬走再看新桶，
+ *   最多访问两个桶，链表长度平均不超过1。
+ *
+ * 读不加锁，也不写任何共享内存：
+ * - 节点发布后键值不再修改，更新时换上新节点，换下与删除的节点交给epoch回收，
+ *   读者在epoch_guard内遍历，访问到的节点不会被释放；
+ * - 每个桶带一个版本号，写者持锁修改前后各加一(奇数表示正在修改)。
+ *   读者记下版本号后遍历，结束时版本号未变则结果有效，否则重试；
+ *   迁移会改写节点的next，读者可能被带到别的链上，靠版本号发现；
+ * - 连续optimistic_retries次失败后退回持读锁查找，保证写多时读者也能前进。
+ *
+ * 快照按分段写时复制：
+ * - take_snapshot在snapshot_mutex下把快照代数加一并登记快照，只分配
+ *   每个分段一个的空副本指针，O(分段数)，不阻塞读，只等进行中的写完成；
+ * - 写者持分段锁修改前，若快照代数比该分段记录的新，先把本分段的当前内容
+ *   复制给所有尚未取得本分段副本的新快照，再修改；
+ * - 遍历快照时，尚无副本的分段在读锁下复制一次，之后遍历副本不持有任何锁。
+ * 写者从读取代数到修改完成一直持有snapshot_gate的共享锁，take_snapshot
+ * 持独占锁把代数加一。读到旧代数的写操作在加一之前已全部完成，
+ * 读到新代数的写操作都在加一之后才开始，快照对应的是代数加一的那一刻，
+ * 不同分段的写者也不会一个落在快照里、另一个先于它被读者看到却落在快照外。
+ *
+ * upsert/compute_if_absent只加一次分段锁，新节点的值直接在节点里构造或修改，
+ * 发布之后不再改动；visit在节点上调用回调，不复制值。
+ * Hash定义了is_transparent时(如transparent_string_hash)，
+ * value_for/visit/upsert/compute_if_absent可以用其他类型的键查找，
+ * 只有真正插入时才构造Key。
+ *
+ * multi_get/multi_put先算出所有键的哈希并按分段分组：
+ * multi_get在一个epoch临界区内依次无锁查找，提前prefetch_distance个键
+ * 预取桶头，再提前一半距离预取链表首节点，校验失败的键最后按分段各加一次读锁；
+ * multi_put每个分段只加一次写锁，写完该分段的全部键。
+ */
+
+#ifndef _THREADSAFE_LOOKUP_TABLE_H_
+#define _THREADSAFE_LOOKUP_TABLE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/utility/string_view.hpp>
+
+#include "ConArch/epoch.hpp"
+
+// std::string、boost::string_view与C字符串得到相同的哈希值
+struct transparent_string_hash {
+  typedef void is_transparent;
+
+  std::size_t operator()(boost::string_view s) const {
+    return boost::hash_range(s.begin(), s.end());
+  }
+};
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class threadsafe_lookup_table {
+public:
+  typedef Key   key_type;
+  typedef Value mapped_type;
+  typedef Hash  hash_type;
+
+  static unsigned const default_stripes = 64;
+  // 每次写操作顺带迁移的旧桶数
+  static unsigned const migrate_batch = 2;
+  // 无锁读连续失败这么多次后改为加读锁
+  static unsigned const optimistic_retries = 4;
+  // 批量查找时提前预取的键数
+  static unsigned const prefetch_distance = 8;
+
+private:
+  struct snapshot_state;
+
+public:
+  // 某一时刻的一致快照，必须在表销毁前析构
+  class snapshot {
+  public:
+    snapshot(snapshot &&other)
+        : table(other.table), state(std::move(other.state)) {
+    }
+
+    snapshot(const snapshot &) = delete;
+    snapshot &operator=(const snapshot &) = delete;
+
+    ~snapshot() {
+      if (state) {
+        table->release_snapshot(state.get());
+      }
+    }
+
+    // 逐个调用f(key, value)
+    template <typename Function>
+    void for_each(Function f) const {
+      for (unsigned i = 0; i < table->stripe_count; i++) {
+        stripe_copy const &copy = table->captured(*state, i);
+        for (std::size_t j = 0; j < copy.size(); j++) {
+          f(copy[j].first, copy[j].second);
+        }
+      }
+    }
+
+    std::map<Key, Value> to_map() const {
+      std::map<Key, Value> res;
+      for_each([&res](Key const &key, Value const &value) {
+        res.insert(std::make_pair(key, value));
+      });
+      return res;
+    }
+
+  private:
+    friend class threadsafe_lookup_table;
+
+    snapshot(threadsafe_lookup_table const *table_,
+             std::unique_ptr<snapshot_state> state_)
+        : table(table_), state(std::move(state_)) {
+    }
+
+    threadsafe_lookup_table const  *table;
+    std::unique_ptr<snapshot_state> state;
+  };
+
+  explicit threadsafe_lookup_table(unsigned    num_buckets = 19,
+                                   Hash const &hasher_     = Hash(),
+                                   unsigned    num_stripes = default_stripes)
+      : stripe_count(round_up_power_of_two(num_stripes)),
+        stripes(new stripe[stripe_count]),
+        buckets(new bucket_array(std::max<std::size_t>(
+            round_up_power_of_two(num_buckets), stripe_count))),
+        bucket_total(buckets.load()->size),
+        resizing(false),
+        migrate_cursor(0),
+        migrated(0),
+        count(0),
+        snapshot_generation(0),
+        hasher(hasher_) {
+  }
+
+  threadsafe_lookup_table(const threadsafe_lookup_table &) = delete;
+  threadsafe_lookup_table &operator=(const threadsafe_lookup_table &) = delete;
+
+  // 已退休的节点与桶数组由epoch域在之后释放
+  ~threadsafe_lookup_table() {
+    bucket_array *const current = buckets.load();
+    if (bucket_array *const previous = current->previous.load()) {
+      delete_chains(previous);
+      delete previous;
+    }
+    delete_chains(current);
+    delete current;
+  }
+
+  Value value_for(Key const &key, Value const &default_value = Value()) const {
+    return read_node(key, [&default_value](node const *found) -> Value {
+      return found ? found->value : default_value;
+    });
+  }
+
+  template <typename K, typename H = Hash,
+            typename = typename H::is_transparent>
+  Value value_for(K const &key, Value const &default_value = Value()) const {
+    return read_node(key, [&default_value](node const *found) -> Value {
+      return found ? found->value : default_value;
+    });
+  }
+
+  // 找到时以const Value&调用f，返回是否找到
+  template <typename K, typename Function>
+  bool visit(K const &key, Function f) const {
+    return read_node(key, [&f](node const *found) -> bool {
+      if (found) {
+        f(found->value);
+      }
+      return found != nullptr;
+    });
+  }
+
+  void add_or_update_mapping(Key const &key, Value const &value) {
+    std::size_t const hash = hasher(key);
+    {
+      boost::shared_lock<boost::shared_mutex> gate{snapshot_gate};
+      std::unique_lock<boost::shared_mutex>   lk{stripe_for(hash).mutex};
+      preserve_for_snapshots(stripe_index(hash));
+      put_locked(hash, key, value);
+    }
+    maintain();
+  }
+
+  // out[i]为keys[i]的值，不存在时为default_value。返回找到的个数
+  std::size_t multi_get(std::vector<Key> const &keys, std::vector<Value> &out,
+                        Value const &default_value = Value()) const {
+    std::vector<std::size_t> hashes(keys.size());
+    for (std::size_t i = 0; i < keys.size(); i++) {
+      hashes[i] = hasher(keys[i]);
+    }
+    std::vector<std::size_t> const order = bucket_order(hashes);
+    std::size_t                    found = 0;
+    std::vector<std::size_t>       failed;
+    out.assign(keys.size(), default_value);
+    {
+      epoch_guard         guard;
+      bucket_array *const current = buckets.load(std::memory_order_acquire);
+      for (std::size_t i = 0; i < order.size(); i++) {
+        if (i + prefetch_distance < order.size()) {
+          prefetch_slot(current, hashes[order[i + prefetch_distance]]);
+        }
+        if (i + prefetch_distance / 2 < order.size()) {
+          prefetch_head(current, hashes[order[i + prefetch_distance / 2]]);
+        }
+        std::size_t const index  = order[i];
+        node const       *result = nullptr;
+        bool              ok     = false;
+        for (unsigned retry = 0; retry < optimistic_retries && !ok; retry++) {
+          ok = optimistic_find(hashes[index], keys[index], result);
+        }
+        if (!ok) {
+          failed.push_back(index);
+        } else if (result) {
+          out[index] = result->value;
+          ++found;
+        }
+      }
+    }
+    // failed仍按分段有序，每个分段加一次读锁
+    for (std::size_t i = 0; i < failed.size();) {
+      unsigned const stripe = stripe_index(hashes[failed[i]]);
+      boost::shared_lock<boost::shared_mutex> lk{stripes[stripe].mutex};
+      for (; i < failed.size() && stripe_index(hashes[failed[i]]) == stripe;
+           i++) {
+        std::size_t const index  = failed[i];
+        node const *const result = find_in(
+            bucket_for(hashes[index])->head.load(), hashes[index], keys[index]);
+        if (result) {
+          out[index] = result->value;
+          ++found;
+        }
+      }
+    }
+    return found;
+  }
+
+  // 同一个键出现多次时以最后一次为准
+  void multi_put(std::vector<std::pair<Key, Value>> const &pairs) {
+    std::vector<std::size_t> hashes(pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); i++) {
+      hashes[i] = hasher(pairs[i].first);
+    }
+    std::vector<std::size_t> const order = bucket_order(hashes);
+    for (std::size_t i = 0; i < order.size();) {
+      unsigned const stripe = stripe_index(hashes[order[i]]);
+      {
+        boost::shared_lock<boost::shared_mutex> gate{snapshot_gate};
+        std::unique_lock<boost::shared_mutex>   lk{stripes[stripe].mutex};
+        preserve_for_snapshots(stripe);
+        for (; i < order.size() && stripe_index(hashes[order[i]]) == stripe;
+             i++) {
+          std::size_t const index = order[i];
+          put_locked(hashes[index], pairs[index].first, pairs[index].second);
+        }
+      }
+      maintain();
+    }
+  }
+
+  // 对key的值调用f(Value&)，不存在时先默认构造。返回是否新插入。
+  // 读者不加锁，所以f作用在即将换上的新节点上，旧值复制一次
+  template <typename K, typename Function>
+  bool upsert(K const &key, Function f) {
+    std::size_t const hash     = hasher(key);
+    bool              inserted = false;
+    {
+      boost::shared_lock<boost::shared_mutex> gate{snapshot_gate};
+      std::unique_lock<boost::shared_mutex>   lk{stripe_for(hash).mutex};
+      preserve_for_snapshots(stripe_index(hash));
+      slot                 &s     = *bucket_for(hash);
+      std::atomic<node *>  *link  = find_link(s, hash, key);
+      node *const           found = link->load();
+      std::unique_ptr<node> fresh(
+          found ? new node(hash, found->key, found->next.load(), found->value)
+                : new node(hash, key, s.head.load()));
+      f(fresh->value);
+      write_scope scope(s);
+      if (found) {
+        replace(link, fresh.release());
+      } else {
+        s.head.store(fresh.release(), std::memory_order_release);
+        ++count;
+        inserted = true;
+      }
+    }
+    maintain();
+    return inserted;
+  }
+
+  // key不存在时用factory()的结果插入，存在时什么也不构造。返回是否新插入
+  template <typename K, typename Factory>
+  bool compute_if_absent(K const &key, Factory factory) {
+    std::size_t const hash = hasher(key);
+    if (read_node(key, [](node const *found) { return found != nullptr; })) {
+      return false;
+    }
+    {
+      boost::shared_lock<boost::shared_mutex> gate{snapshot_gate};
+      std::unique_lock<boost::shared_mutex>   lk{stripe_for(hash).mutex};
+      slot &s = *bucket_for(hash);
+      if (find_link(s, hash, key)->load()) {
+        return false;
+      }
+      preserve_for_snapshots(stripe_index(hash));
+      node *const fresh = new node(hash, key, s.head.load(), factory());
+      write_scope scope(s);
+      s.head.store(fresh, std::memory_order_release);
+      ++count;
+    }
+    maintain();
+    return true;
+  }
+
+  void remove_mapping(Key const &key) {
+    std::size_t const hash = hasher(key);
+    {
+      boost::shared_lock<boost::shared_mutex> gate{snapshot_gate};
+      std::unique_lock<boost::shared_mutex>   lk{stripe_for(hash).mutex};
+      slot                &s    = *bucket_for(hash);
+      std::atomic<node *> *link = find_link(s, hash, key);
+      if (node *const found = link->load()) {
+        preserve_for_snapshots(stripe_index(hash));
+        write_scope scope(s);
+        // 正在found上的读者仍能沿found->next走完剩余部分
+        link->store(found->next.load(), std::memory_order_release);
+        default_epoch_domain().retire(found);
+        --count;
+      }
+    }
+    maintain();
+  }
+
+  snapshot take_snapshot() const {
+    std::unique_lock<boost::shared_mutex> gate{snapshot_gate};
+    std::lock_guard<std::mutex>           lk{snapshot_mutex};
+    std::unique_ptr<snapshot_state>       state(
+        new snapshot_state(++snapshot_generation, stripe_count));
+    live_snapshots.push_back(state.get());
+    return snapshot(this, std::move(state));
+  }
+
+  std::map<Key, Value> get_map() const {
+    return take_snapshot().to_map();
+  }
+
+  std::size_t size() const {
+    return count.load(std::memory_order_relaxed);
+  }
+
+  std::size_t bucket_count() const {
+    return bucket_total.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct node {
+    std::size_t const   hash;
+    Key const           key;
+    Value               value;  // 发布之后只读
+    std::atomic<node *> next;   // 只有迁移会改写已发布节点的next
+
+    // value由args直接构造，key可以是其他类型的键
+    template <typename K, typename... Args>
+    node(std::size_t hash_, K const &key_, node *next_, Args &&...args)
+        : hash(hash_),
+          key(key_),
+          value(std::forward<Args>(args)...),
+          next(next_) {
+    }
+  };
+
+  struct slot {
+    std::atomic<node *>        head;
+    std::atomic<std::uint32_t> version;  // 奇数表示正在修改
+
+    slot() : head(nullptr), version(0) {
+    }
+  };
+
+  struct bucket_array {
+    std::size_t const             size;
+    std::unique_ptr<slot[]> const slots;
+    std::atomic<bucket_array *>   previous;  // 迁移中的旧数组
+
+    explicit bucket_array(std::size_t size_, bucket_array *previous_ = nullptr)
+        : size(size_), slots(new slot[size_]), previous(previous_) {
+    }
+  };
+
+  // 持锁修改一个桶期间让版本号保持奇数
+  class write_scope {
+  public:
+    explicit write_scope(slot &s_) : s(s_) {
+      s.version.store(s.version.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    write_scope(write_scope const &) = delete;
+    write_scope &operator=(write_scope const &) = delete;
+
+    ~write_scope() {
+      s.version.store(s.version.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+    }
+
+  private:
+    slot &s;
+  };
+
+  typedef std::vector<std::pair<Key, Value>> stripe_copy;
+
+  struct snapshot_state {
+    std::uint64_t const                                 generation;
+    unsigned const                                      stripes;
+    std::unique_ptr<std::atomic<stripe_copy *>[]> const copies;
+
+    snapshot_state(std::uint64_t generation_, unsigned stripes_)
+        : generation(generation_),
+          stripes(stripes_),
+          copies(new std::atomic<stripe_copy *>[stripes_]) {
+      for (unsigned i = 0; i < stripes; i++) {
+        copies[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    ~snapshot_state() {
+      for (unsigned i = 0; i < stripes; i++) {
+        delete copies[i].load();
+      }
+    }
+  };
+
+  struct stripe {
+    mutable boost::shared_mutex mutex;
+    std::uint64_t               captured_generation;  // 此前的快照都已取得副本
+    char                        padding[64];
+
+    stripe() : captured_generation(0) {
+    }
+  };
+
+  // buckets与其previous只在持有全部分段锁时替换
+  unsigned const                        stripe_count;
+  std::unique_ptr<stripe[]> const       stripes;
+  std::atomic<bucket_array *>           buckets;
+  std::atomic<std::size_t>              bucket_total;
+  std::atomic<bool>                     resizing;
+  std::atomic<std::size_t>              migrate_cursor;  // 下一个待认领的旧桶
+  std::atomic<std::size_t>              migrated;        // 已搬完的旧桶数
+  std::atomic<std::size_t>              count;
+  mutable std::atomic<std::uint64_t>    snapshot_generation;
+  // 写者持共享锁读代数并完成修改，take_snapshot持独占锁增加代数
+  mutable boost::shared_mutex           snapshot_gate;
+  mutable std::mutex                    snapshot_mutex;  // 保护live_snapshots
+  mutable std::vector<snapshot_state *> live_snapshots;
+  Hash                                  hasher;
+
+  static std::size_t round_up_power_of_two(std::size_t n) {
+    std::size_t res = 1;
+    while (res < n) {
+      res <<= 1;
+    }
+    return res;
+  }
+
+  // 已迁移旧桶的标记，不指向任何节点
+  static node *moved() {
+    return reinterpret_cast<node *>(std::uintptr_t(1));
+  }
+
+  unsigned stripe_index(std::size_t hash) const {
+    return static_cast<unsigned>(hash & (stripe_count - 1));
+  }
+
+  stripe &stripe_for(std::size_t hash) const {
+    return stripes[stripe_index(hash)];
+  }
+
+  // 调用者持有hash所在分段的锁
+  slot *bucket_for(std::size_t hash) const {
+    bucket_array *const current = buckets.load(std::memory_order_relaxed);
+    if (bucket_array *const previous = current->previous.load()) {
+      slot &s = previous->slots[hash & (previous->size - 1)];
+      if (s.head.load(std::memory_order_relaxed) != moved()) {
+        return &s;
+      }
+    }
+    return &current->slots[hash & (current->size - 1)];
+  }
+
+  // 无锁查找后以找到的节点(或nullptr)调用f并返回其结果，
+  // 多次校验失败后改为持读锁查找
+  template <typename K, typename Function>
+  typename std::result_of<Function(node const *)>::type read_node(
+      K const &key, Function f) const {
+    std::size_t const hash = hasher(key);
+    {
+      epoch_guard guard;
+      for (unsigned i = 0; i < optimistic_retries; i++) {
+        node const *found = nullptr;
+        if (optimistic_find(hash, key, found)) {
+          return f(found);
+        }
+      }
+    }
+    boost::shared_lock<boost::shared_mutex> lk{stripe_for(hash).mutex};
+    return f(find_in(bucket_for(hash)->head.load(), hash, key));
+  }
+
+  // 调用者持有分段写锁并已调用preserve_for_snapshots
+  void put_locked(std::size_t hash, Key const &key, Value const &value) {
+    slot                &s    = *bucket_for(hash);
+    std::atomic<node *> *link = find_link(s, hash, key);
+    write_scope          scope(s);
+    if (node *const found = link->load()) {
+      replace(link, new node(hash, key, found->next.load(), value));
+    } else {
+      s.head.store(new node(hash, key, s.head.load(), value),
+                   std::memory_order_release);
+      ++count;
+    }
+  }
+
+  // 按分段计数排序后的下标，同一分段内保持原有顺序。
+  // 桶号的低位就是分段号，同一个桶的键必然相邻于同一分段
+  std::vector<std::size_t> bucket_order(
+      std::vector<std::size_t> const &hashes) const {
+    std::vector<std::size_t> starts(stripe_count + 1, 0);
+    for (std::size_t i = 0; i < hashes.size(); i++) {
+      ++starts[stripe_index(hashes[i]) + 1];
+    }
+    for (unsigned i = 0; i < stripe_count; i++) {
+      starts[i + 1] += starts[i];
+    }
+    std::vector<std::size_t> order(hashes.size());
+    for (std::size_t i = 0; i < hashes.size(); i++) {
+      order[starts[stripe_index(hashes[i])]++] = i;
+    }
+    return order;
+  }
+
+  // 调用者处于epoch临界区
+  static void prefetch_slot(bucket_array const *current, std::size_t hash) {
+    __builtin_prefetch(&current->slots[hash & (current->size - 1)]);
+  }
+
+  static void prefetch_head(bucket_array const *current, std::size_t hash) {
+    node const *const head =
+        current->slots[hash & (current->size - 1)].head.load(
+            std::memory_order_relaxed);
+    if (head && head != moved()) {
+      __builtin_prefetch(head);
+    }
+  }
+
+  // 调用者持有分段写锁与write_scope，把link指向的节点换成fresh
+  static void replace(std::atomic<node *> *link, node *fresh) {
+    node *const old = link->load(std::memory_order_relaxed);
+    link->store(fresh, std::memory_order_release);
+    default_epoch_domain().retire(old);
+  }
+
+  // 调用者处于epoch临界区。版本号校验通过返回true，found为查找结果
+  template <typename K>
+  bool optimistic_find(std::size_t hash, K const &key,
+                       node const *&found) const {
+    bucket_array *const current = buckets.load(std::memory_order_acquire);
+    bucket_array *const previous =
+        current->previous.load(std::memory_order_acquire);
+    if (previous) {
+      slot &s = previous->slots[hash & (previous->size - 1)];
+      if (read_slot(s, hash, key, found)) {
+        return true;
+      }
+      if (s.head.load(std::memory_order_acquire) != moved()) {
+        return false;
+      }
+    }
+    return read_slot(current->slots[hash & (current->size - 1)], hash, key,
+                     found);
+  }
+
+  // 桶已搬走或版本号变化时返回false
+  template <typename K>
+  static bool read_slot(slot &s, std::size_t hash, K const &key,
+                        node const *&found) {
+    std::uint32_t const version = s.version.load(std::memory_order_acquire);
+    if (version & 1) {
+      return false;
+    }
+    node *const head = s.head.load(std::memory_order_acquire);
+    if (head == moved()) {
+      return false;
+    }
+    found = find_in(head, hash, key);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.version.load(std::memory_order_relaxed) == version;
+  }
+
+  template <typename K>
+  static node *find_in(node *head, std::size_t hash, K const &key) {
+    for (node *current = head; current;
+         current = current->next.load(std::memory_order_acquire)) {
+      if (current->hash == hash && current->key == key) {
+        return current;
+      }
+    }
+    return nullptr;
+  }
+
+  // 调用者持有分段锁。返回指向key所在节点的链接，不存在时指向链尾的nullptr
+  template <typename K>
+  static std::atomic<node *> *find_link(slot &s, std::size_t hash,
+                                        K const &key) {
+    std::atomic<node *> *link = &s.head;
+    for (node *current = link->load(); current; current = link->load()) {
+      if (current->hash == hash && current->key == key) {
+        break;
+      }
+      link = &current->next;
+    }
+    return link;
+  }
+
+  static void delete_chains(bucket_array *chains) {
+    for (std::size_t i = 0; i < chains->size; i++) {
+      node *current = chains->slots[i].head.load();
+      if (current == moved()) {
+        continue;
+      }
+      while (current) {
+        node *const next = current->next.load();
+        delete current;
+        current = next;
+      }
+    }
+  }
+
+  // 调用者持有分段index的锁，复制该分段在新旧两个数组中的全部内容
+  stripe_copy *capture(unsigned index) const {
+    std::unique_ptr<stripe_copy> res(new stripe_copy);
+    bucket_array const *const    current = buckets.load();
+    copy_stripe(current->previous.load(), index, *res);
+    copy_stripe(current, index, *res);
+    return res.release();
+  }
+
+  void copy_stripe(bucket_array const *chains, unsigned index,
+                   stripe_copy &res) const {
+    if (!chains) {
+      return;
+    }
+    for (std::size_t i = index; i < chains->size; i += stripe_count) {
+      node const *current = chains->slots[i].head.load();
+      if (current == moved()) {
+        continue;
+      }
+      for (; current; current = current->next.load()) {
+        res.push_back(std::make_pair(current->key, current->value));
+      }
+    }
+  }
+
+  // 写者持有分段index的写锁，修改之前调用
+  void preserve_for_snapshots(unsigned index) {
+    std::uint64_t const generation = snapshot_generation.load();
+    stripe             &st         = stripes[index];
+    if (st.captured_generation == generation) {
+      return;
+    }
+    std::lock_guard<std::mutex> lk{snapshot_mutex};
+    // 代数大于generation的快照登记在本次读取之后，本次修改属于它们之前
+    for (std::size_t i = 0; i < live_snapshots.size(); i++) {
+      snapshot_state &state = *live_snapshots[i];
+      if (state.generation <= generation &&
+          !state.copies[index].load(std::memory_order_relaxed)) {
+        state.copies[index].store(capture(index), std::memory_order_release);
+      }
+    }
+    st.captured_generation = generation;
+  }
+
+  stripe_copy const &captured(snapshot_state &state, unsigned index) const {
+    stripe_copy *copy = state.copies[index].load(std::memory_order_acquire);
+    if (copy) {
+      return *copy;
+    }
+    boost::shared_lock<boost::shared_mutex> lk{stripes[index].mutex};
+    copy = state.copies[index].load(std::memory_order_acquire);
+    if (copy) {
+      return *copy;
+    }
+    // 同一快照可能被多个线程同时遍历，先装上的为准
+    stripe_copy *const fresh = capture(index);
+    if (state.copies[index].compare_exchange_strong(copy, fresh)) {
+      return *fresh;
+    }
+    delete fresh;
+    return *copy;
+  }
+
+  void release_snapshot(snapshot_state *state) const {
+    std::lock_guard<std::mutex> lk{snapshot_mutex};
+    live_snapshots.erase(
+        std::find(live_snapshots.begin(), live_snapshots.end(), state));
+  }
+
+  // 写操作释放分段锁之后调用：迁移若干旧桶，或在元素过多时开始扩容
+  void maintain() {
+    if (resizing.load()) {
+      for (unsigned i = 0; i < migrate_batch; i++) {
+        if (!migrate_one()) {
+          break;
+        }
+      }
+    } else if (count.load(std::memory_order_relaxed) >
+               bucket_total.load(std::memory_order_relaxed)) {
+      start_resize();
+    }
+  }
+
+  void lock_all(std::vector<std::unique_lock<boost::shared_mutex>> &locks) {
+    for (unsigned i = 0; i < stripe_count; i++) {
+      locks.push_back(std::unique_lock<boost::shared_mutex>(stripes[i].mutex));
+    }
+  }
+
+  void start_resize() {
+    std::vector<std::unique_lock<boost::shared_mutex>> locks;
+    lock_all(locks);
+    bucket_array *const current = buckets.load();
+    if (resizing.load() || count.load() <= current->size) {
+      return;
+    }
+    buckets.store(new bucket_array(current->size * 2, current),
+                  std::memory_order_release);
+    bucket_total.store(current->size * 2);
+    migrate_cursor.store(0);
+    migrated.store(0);
+    resizing.store(true);
+  }
+
+  // 认领并迁移一个旧桶，没有可认领的旧桶时返回false
+  bool migrate_one() {
+    std::size_t const index = migrate_cursor.fetch_add(1);
+    bool              last  = false;
+    {
+      std::unique_lock<boost::shared_mutex> lk{stripe_for(index).mutex};
+      // 本轮旧桶未全部搬完之前previous不会被替换
+      bucket_array *const current  = buckets.load();
+      bucket_array *const previous = current->previous.load();
+      if (!previous || index >= previous->size) {
+        return false;
+      }
+      slot &from = previous->slots[index];
+      // 上一轮迟到的认领可能落到本轮的桶上，只由实际搬运的线程计数
+      if (from.head.load(std::memory_order_relaxed) == moved()) {
+        return true;
+      }
+      std::size_t const mask = current->size - 1;
+      {
+        write_scope scope(from);
+        node       *moving = from.head.load(std::memory_order_relaxed);
+        // 新桶只接收这一个旧桶的节点，读者在看到moved()之前不会访问它们
+        while (moving) {
+          node *const          next = moving->next.load();
+          std::atomic<node *> &head = current->slots[moving->hash & mask].head;
+          moving->next.store(head.load(), std::memory_order_relaxed);
+          head.store(moving, std::memory_order_release);
+          moving = next;
+        }
+        from.head.store(moved(), std::memory_order_release);
+      }
+      last = migrated.fetch_add(1) + 1 == previous->size;
+    }
+    if (last) {
+      finish_resize();
+    }
+    return true;
+  }
+
+  void finish_resize() {
+    std::vector<std::unique_lock<boost::shared_mutex>> locks;
+    lock_all(locks);
+    bucket_array *const current = buckets.load();
+    // 仍在previous上的读者只会看到moved()，之后转到当前数组
+    default_epoch_domain().retire(current->previous.exchange(nullptr));
+    resizing.store(false);
+  }
+};
+
+#endif  // !_THREADSAFE_LOOKUP_TABLE_H_
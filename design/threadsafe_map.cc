@@ -9,109 +9,317 @@
  *
  */
 
-#include <boost/thread/shared_mutex.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
-#include <list>
-#include <memory>
-#include <mutex>
+#include <map>
+#include <random>
+#include <string>
 #include <thread>
+#include <vector>
 
-template <typename Key, typename Value, typename Hash = std::hash<Key>>
-class threadsafe_lookup_table {
-public:
-  typedef Key   key_type;
-  typedef Value mapped_type;
-  typedef Hash  hash_type;
-
-  threadsafe_lookup_table(unsigned    num_buckets = 19,
-                          Hash const &hasher_     = Hash())
-      : buckets(num_buckets),
-        hasher(hasher_) {
-    for (unsigned i = 0; i < num_buckets; i++) {
-      buckets[i].reset(new bucket_type);
-    }
-  }
+#include "filtered_lookup_table.hpp"
+#include "flat_lookup_table.hpp"
+#include "split_ordered_table.hpp"
+#include "threadsafe_lookup_table.hpp"
 
-  threadsafe_lookup_table(const threadsafe_lookup_table &) = delete;
-  threadsafe_lookup_table &operator=(const threadsafe_lookup_table &) = delete;
+// 多线程插入、更新、删除后，与预期结果逐个比较
+template <typename Table>
+bool exercise(char const *name) {
+  unsigned const threads = 4;
+  unsigned const per     = 50000;
 
-  Value value_for(Key const &key, Value const &default_value = Value()) const {
-    return get_bucket(key).value_for(key.default_value);
-  }
+  // 从很小的容量开始，插入过程中多次扩容
+  Table table;
 
-  void add_or_update_mapping(Key const &key, Value const &value) {
-    get_bucket(key).add_or_update_mapping(key, value);
+  // 只读线程在扩容过程中反复查找，读到的值只能是默认值、key或key * 2
+  std::atomic<bool>        done(false);
+  std::atomic<bool>        torn(false);
+  std::vector<std::thread> readers;
+  for (unsigned t = 0; t < 2; t++) {
+    readers.push_back(std::thread([&table, &done, &torn, t] {
+      for (unsigned key = t; !done.load(); key = (key + 7919) % (4 * 50000)) {
+        unsigned const value = table.value_for(key, ~0u);
+        if (value != ~0u && value != key && value != key * 2) {
+          torn.store(true);
+        }
+      }
+    }));
   }
 
-  void remove_mapping(Key const &key) {
-    get_bucket(key).remove_mapping(key);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&table, t, per] {
+      for (unsigned i = 0; i < per; i++) {
+        unsigned const key = t * per + i;
+        table.add_or_update_mapping(key, key);
+        // 偶数键再更新一次，每隔三个键删掉一个
+        if (key % 2 == 0) {
+          table.add_or_update_mapping(key, key * 2);
+        }
+        if (key % 3 == 0) {
+          table.remove_mapping(key);
+        }
+        if (table.value_for(key, key + 1) == key + 1 && key % 3 != 0) {
+          std::cout << "lost key " << key << std::endl;
+        }
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  done.store(true);
+  for (std::size_t i = 0; i < readers.size(); i++) {
+    readers[i].join();
   }
 
-  std::map<Key, Value> get_map() const {
-    std::vector<std::unique_lock<boost::shared_mutex>> locks;
-    for (unsigned i = 0; i < buckets.size(); i++) {
-      locks.push_back(std::unique_lock<boost::shared_mutex>(buckets[i].muetx));
+  std::map<unsigned, unsigned> const res = table.get_map();
+  bool ok = res.size() == table.size() && !torn.load();
+  for (unsigned key = 0; key < threads * per; key++) {
+    auto const     it       = res.find(key);
+    unsigned const expected = key % 2 == 0 ? key * 2 : key;
+    if (key % 3 == 0) {
+      ok = it == res.end() && ok;
+    } else {
+      ok = it != res.end() && it->second == expected && ok;
     }
+  }
+  std::cout << name << ": size " << table.size()
+            << (ok ? ", ok" : ", mismatch") << std::endl;
+  return ok;
+}
 
-    std::map<Key, Value> res;
-    for (unsigned i = 0; i < buckets.size(); i++) {
-      for (auto it = buckets[i].data.begin(); it != buckets[i].data.end();
-           ++it) {
-        res.insert(*it);
+// 写者按顺序给一组键写入同一个版本号，任何一致的快照中，
+// 前面的键的版本号不小于后面的键，且最多相差一
+bool check_snapshots() {
+  unsigned const                              keys     = 64;
+  unsigned const                              versions = 20000;
+  threadsafe_lookup_table<unsigned, unsigned> table;
+  for (unsigned key = 0; key < keys; key++) {
+    table.add_or_update_mapping(key, 0);
+  }
+  std::thread writer([&table, keys, versions] {
+    for (unsigned v = 1; v <= versions; v++) {
+      for (unsigned key = 0; key < keys; key++) {
+        table.add_or_update_mapping(key, v);
       }
     }
-    return res;
+  });
+  bool     ok     = true;
+  unsigned checks = 0;
+  for (; table.value_for(keys - 1) < versions; checks++) {
+    std::map<unsigned, unsigned> const res = table.take_snapshot().to_map();
+    ok = res.size() == keys && ok;
+    for (unsigned key = 1; key < res.size(); key++) {
+      unsigned const before = res.at(key - 1);
+      unsigned const after  = res.at(key);
+      ok = before >= after && before - after <= 1 && ok;
+    }
   }
+  writer.join();
+  std::cout << "snapshots: " << checks << " checked"
+            << (ok ? ", ok" : ", inconsistent") << std::endl;
+  return ok;
+}
 
-private:
-  class bucket_type {
-  public:
-    Value value_for(Key const &key, Value const &default_value) const {
-      boost::shared_lock<boost::shared_mutex> lk{mutex};
-      bucket_iterator const                   find_entry = find_entry_for(key);
-      return find_entry == data.end() ? default_value : find_entry->second;
+// 两个写者在不同分段上：一个不断递增键1，另一个把键1的当前值写入键0。
+// 键0的值是从键1读来的，任何一致的快照中键0都不大于键1
+bool check_snapshot_across_stripes() {
+  unsigned const                              snapshots = 2000;
+  threadsafe_lookup_table<unsigned, unsigned> table;
+  table.add_or_update_mapping(0, 0);
+  table.add_or_update_mapping(1, 0);
+  std::atomic<bool> done(false);
+  std::thread       counter([&table, &done] {
+    for (unsigned v = 1; !done.load(); v++) {
+      table.add_or_update_mapping(1, v);
+      std::this_thread::yield();
+    }
+  });
+  std::thread copier([&table, &done] {
+    while (!done.load()) {
+      table.upsert(0u, [&table](unsigned &value) {
+        // 已经读过快照代数，停顿片刻让快照与另一个写者插进来
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        value = table.value_for(1);
+      });
     }
+  });
+  bool ok = true;
+  for (unsigned i = 0; i < snapshots; i++) {
+    std::map<unsigned, unsigned> const res = table.take_snapshot().to_map();
+    ok = res.at(0) <= res.at(1) && ok;
+  }
+  done = true;
+  counter.join();
+  copier.join();
+  std::cout << "snapshot stripes: " << snapshots << " checked"
+            << (ok ? ", ok" : ", inconsistent") << std::endl;
+  return ok;
+}
 
-    void add_or_update_mapping(Key const &key, Value const &value) {
-      std::unique_lock<boost::shared_mutex> lk{mutex};
-      bucket_iterator const                 found_entry = find_entry_for(key);
-      if (found_entry == data.end()) {
-        data.push_back(std::make_pair(key, value));
-      } else {
-        found_entry->second = value;
+// 多个线程用upsert给同一组字符串键计数，用string_view查找，不构造std::string
+bool check_counters() {
+  unsigned const threads = 4;
+  unsigned const per     = 50000;
+  unsigned const keys    = 100;
+  threadsafe_lookup_table<std::string, unsigned long, transparent_string_hash>
+                           counters;
+  std::vector<std::string> names;
+  for (unsigned i = 0; i < keys; i++) {
+    names.push_back("counter-" + std::to_string(i));
+  }
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&counters, &names, t, per, keys] {
+      for (unsigned i = 0; i < per; i++) {
+        boost::string_view const name(names[(i + t) % keys]);
+        counters.upsert(name, [](unsigned long &value) { ++value; });
       }
+    }));
+  }
+  for (std::size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+  unsigned long total = 0;
+  for (unsigned i = 0; i < keys; i++) {
+    counters.visit(boost::string_view(names[i]),
+                   [&total](unsigned long const &value) { total += value; });
+  }
+  bool const ok = total == threads * per && counters.size() == keys &&
+                  !counters.compute_if_absent("counter-0", [] { return 0ul; });
+  std::cout << "counters: " << total << (ok ? ", ok" : ", mismatch")
+            << std::endl;
+  return ok;
+}
+
+// 批量写入后批量读回，并与逐个value_for比较每个键的耗时
+bool check_batches() {
+  unsigned const                              keys  = 1 << 20;
+  unsigned const                              batch = 128;
+  unsigned const                              loops = 4000;
+  threadsafe_lookup_table<unsigned, unsigned> table;
+  std::vector<std::pair<unsigned, unsigned>>  pairs;
+  for (unsigned key = 0; key < keys; key++) {
+    pairs.push_back(std::make_pair(key, key + 1));
+    if (pairs.size() == batch) {
+      table.multi_put(pairs);
+      pairs.clear();
     }
+  }
 
-    void remove_mapping(Key const &key) {
-      std::unique_lock<boost::shared_mutex> uk{mutex};
-      bucket_iterator                       found_entry = find_entry_for(key);
-      if (found_entry != data.end()) {
-        data.erase(found_entry);
-      }
+  std::mt19937                            random(7);
+  std::uniform_int_distribution<unsigned> pick(0, keys * 2 - 1);
+  std::vector<unsigned>                   wanted(batch);
+  std::vector<unsigned>                   others(batch);
+  std::vector<unsigned>                   got;
+  bool                                    ok      = table.size() == keys;
+  std::int64_t                            batched = 0;
+  std::int64_t                            single  = 0;
+  for (unsigned loop = 0; loop < loops; loop++) {
+    // 两种方式查不同的键，避免后者沾前者预热缓存的光
+    for (unsigned i = 0; i < batch; i++) {
+      wanted[i] = pick(random);
+      others[i] = pick(random);
+    }
+    auto const        start = std::chrono::steady_clock::now();
+    std::size_t const found = table.multi_get(wanted, got);
+    auto const        mid   = std::chrono::steady_clock::now();
+    unsigned          sum   = 0;
+    for (unsigned i = 0; i < batch; i++) {
+      sum += table.value_for(others[i]);
     }
+    auto const end = std::chrono::steady_clock::now();
+    batched += std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start)
+                   .count();
+    single +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count();
 
-  private:
-    typedef std::pair<Key, Value>          bucket_value;
-    typedef std::list<bucket_value>        bucket_data;
-    typedef typename bucket_data::iterator bucket_iterator;
-    bucket_data                            data;
-    mutable boost::shared_mutex            mutex;
-
-    bucket_iterator find_entry_for(Key const &key) const {
-      return std::find_if(data.begin(), data.end(),
-                          [&](bucket_value const &item) {
-                            return item.first == key;
-                          });
+    std::size_t expected_found = 0;
+    unsigned    expected_sum   = 0;
+    for (unsigned i = 0; i < batch; i++) {
+      unsigned const expected = wanted[i] < keys ? wanted[i] + 1 : 0;
+      expected_found += wanted[i] < keys;
+      expected_sum += others[i] < keys ? others[i] + 1 : 0;
+      ok = got[i] == expected && ok;
     }
-  };
+    ok = found == expected_found && sum == expected_sum && ok;
+  }
+  std::cout << "batches: multi_get " << batched / (loops * batch)
+            << " ns/key, value_for " << single / (loops * batch) << " ns/key"
+            << (ok ? ", ok" : ", mismatch") << std::endl;
+  return ok;
+}
 
-  std::vector<std::unique_ptr<bucket_type>> buckets;
-  Hash                                      hasher;
-  bucket_type &                             get_bucket(Key const &key) const {
-    std::size_t const bucket_index = hasher(key) % buckets.size();
-    return *buckets[bucket_index];
+// 在很大的键空间中随机查找一定不存在的奇数键，返回每次查找的纳秒数
+template <typename Table>
+std::int64_t miss_ns(Table const &table, unsigned probes, bool &ok) {
+  std::mt19937                            random(11);
+  std::uniform_int_distribution<unsigned> pick(0, 1u << 30);
+  auto const start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < probes; i++) {
+    ok = table.value_for(pick(random) | 1, ~0u) == ~0u && ok;
+  }
+  auto const end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+             .count() /
+         probes;
+}
+
+// 大部分查找未命中：有无过滤器的对比；删除大半后过滤器重建，仍不漏键
+bool check_filter() {
+  unsigned const                              keys   = 200000;
+  unsigned const                              probes = 1000000;
+  threadsafe_lookup_table<unsigned, unsigned> plain;
+  filtered_lookup_table<unsigned, unsigned>   filtered;
+  // 随机的偶数键，未命中的奇数键落在有元素的桶里
+  std::mt19937                            random(5);
+  std::uniform_int_distribution<unsigned> pick(0, 1u << 30);
+  std::map<unsigned, unsigned>            expected;
+  while (expected.size() < keys) {
+    unsigned const key = pick(random) & ~1u;
+    expected[key]      = key / 2;
+    plain.add_or_update_mapping(key, key / 2);
+    filtered.add_or_update_mapping(key, key / 2);
+  }
+  bool               ok          = true;
+  std::int64_t const plain_ns    = miss_ns(plain, probes, ok);
+  std::int64_t const filtered_ns = miss_ns(filtered, probes, ok);
+
+  // 每十个键留一个
+  std::size_t const capacity = filtered.filter_capacity();
+  unsigned          i        = 0;
+  for (auto it = expected.begin(); it != expected.end(); i++) {
+    if (i % 10 != 0) {
+      filtered.remove_mapping(it->first);
+      it = expected.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ok = filtered.get_map() == expected && ok;
+  for (auto it = expected.begin(); it != expected.end(); ++it) {
+    ok = filtered.value_for(it->first, ~0u) == it->second && ok;
   }
-};
+  ok = filtered.filter_capacity() < capacity && ok;
+  std::cout << "filter: miss " << plain_ns << " ns without, " << filtered_ns
+            << " ns with, capacity " << capacity << " -> "
+            << filtered.filter_capacity() << (ok ? ", ok" : ", mismatch")
+            << std::endl;
+  return ok;
+}
 
 int main(int argc, char **argv) {
-}
\ No newline at end of file
+  bool ok = exercise<threadsafe_lookup_table<unsigned, unsigned>>("striped");
+  ok      = exercise<flat_lookup_table<unsigned, unsigned>>("flat") && ok;
+  ok      = exercise<split_ordered_table<unsigned, unsigned>>("split") && ok;
+  ok = exercise<filtered_lookup_table<unsigned, unsigned>>("filtered") && ok;
+  ok      = check_snapshots() && ok;
+  ok      = check_snapshot_across_stripes() && ok;
+  ok      = check_counters() && ok;
+  ok      = check_batches() && ok;
+  ok      = check_filter() && ok;
+  return ok ? 0 : 1;
+}